@@ -25,68 +25,449 @@
 #define CPPARG_HPP_INCLUDED
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <charconv>
+#include <cmath>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
 #include <expected>
 #include <format>
+#include <functional>
 #include <iterator>
 #include <limits>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
 #include <optional>
+#include <ranges>
+#include <span>
 #include <string>
 #include <string_view>
 #include <system_error>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#if defined(_WIN32)
+#  include <cstdlib>
+#endif
+
+// Define CPPARG_USE_MMAP to memory map response and config files on POSIX
+// systems, which includes system headers. Otherwise files are read.
+#if defined(CPPARG_USE_MMAP) && !defined(_WIN32)
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#else
+#  include <filesystem>
+#endif
+
+#if __has_include(<generator>)
+#  include <generator>
+#endif
+
 namespace cpparg {
 
 namespace detail {
 
+// Bit 7 of each byte of the result is set if the byte in `x` is nonzero
+constexpr auto swar_nonzero_bytes(std::uint64_t x) -> std::uint64_t {
+	constexpr std::uint64_t low7 = 0x7F7F7F7F7F7F7F7FULL;
+
+	return (((x & low7) + low7) | x) & ~low7;
+}
+
+/// @brief Find first character in [p, end) that is (or is not) a space,
+/// eight characters at a time.
+template<bool space>
+auto find_space_swar(const char *p, const char *end) -> const char * {
+	constexpr std::uint64_t spaces = 0x2020202020202020ULL;
+	constexpr std::uint64_t high = 0x8080808080808080ULL;
+
+	while (end - p >= 8) {
+		std::uint64_t x = 0;
+
+		std::memcpy(&x, p, 8);
+
+		auto not_spaces = swar_nonzero_bytes(x ^ spaces);
+
+		if (auto mask = space ? ~not_spaces & high : not_spaces; mask != 0) {
+			return p + std::countr_zero(mask) / 8;
+		}
+
+		p += 8;
+	}
+
+	while (p != end && (*p == ' ') != space) {
+		++p;
+	}
+
+	return p;
+}
+
+/// @brief Find first character in [p, end) that is (or is not) a space.
+template<bool space>
+constexpr auto find_space(const char *p, const char *end) -> const char * {
+	auto is_match = [](char ch) { return (ch == ' ') == space; };
+
+	// Words and runs of spaces are usually short, so check the first
+	// characters one at a time
+	auto *stop = p + std::min<std::ptrdiff_t>(end - p, 16);
+
+	if (p = std::find_if(p, stop, is_match); p != stop || p == end) {
+		return p;
+	}
+
+	if !consteval {
+		if constexpr (std::endian::native == std::endian::little) {
+			return find_space_swar<space>(p, end);
+		}
+	}
+
+	return std::find_if(p, end, is_match);
+}
+
+} // namespace detail
+
+/// @brief Lazy view of the lines of word wrapped text.
+///
+/// See `word_wrap()`. The lines are found as the view is iterated, so no
+/// memory is allocated.
+class WordWrapView : public std::ranges::view_interface<WordWrapView> {
+public:
+	class iterator {
+	public:
+		using value_type = std::string_view;
+		using difference_type = std::ptrdiff_t;
+
+		constexpr iterator() = default;
+
+		constexpr auto operator*() const -> std::string_view {
+			return line;
+		}
+
+		constexpr auto operator++() -> iterator & {
+			next();
+
+			return *this;
+		}
+
+		constexpr auto operator++(int) -> iterator {
+			auto tmp = *this;
+
+			next();
+
+			return tmp;
+		}
+
+		constexpr auto operator==(const iterator &other) const -> bool {
+			return done == other.done && line.data() == other.line.data();
+		}
+
+		constexpr auto operator==(std::default_sentinel_t) const -> bool {
+			return done;
+		}
+
+	private:
+		friend WordWrapView;
+
+		const char *end = nullptr;
+		std::size_t width = 0;
+
+		// Start of the next line, and of the space after its first word
+		const char *line_start = nullptr;
+		const char *space_begin = nullptr;
+
+		std::string_view line;
+		// True once the rest after the last break is returned, or if it
+		// need not be because it is empty and the text is not
+		bool rest_done = false;
+		bool done = true;
+
+		constexpr iterator(std::string_view sv, std::size_t width)
+			: end(sv.data() + sv.size()), width(width), done(false) {
+			// Skip leading space
+			line_start = detail::find_space<false>(sv.data(), end);
+			space_begin = detail::find_space<true>(line_start, end);
+
+			// Empty text gives a single empty line
+			rest_done = !sv.empty();
+
+			next();
+		}
+
+		constexpr auto next() -> void {
+			while (space_begin != end) {
+				auto space_end = detail::find_space<false>(space_begin, end);
+
+				auto next_space_begin = detail::find_space<true>(space_end, end);
+
+				// If breaking at the next space would exceed width, break here
+				if (static_cast<std::size_t>(next_space_begin - line_start) > width) {
+					line = std::string_view(line_start, space_begin);
+
+					line_start = space_end;
+					space_begin = next_space_begin;
+
+					return;
+				}
+
+				space_begin = next_space_begin;
+			}
+
+			if (line_start != end || !rest_done) {
+				line = std::string_view(line_start, end);
+
+				line_start = end;
+				rest_done = true;
+
+				return;
+			}
+
+			line = {};
+			done = true;
+		}
+	};
+
+	constexpr WordWrapView() = default;
+
+	constexpr WordWrapView(std::string_view sv, std::size_t width)
+		: sv(sv), width(width) {}
+
+	constexpr auto begin() const -> iterator {
+		return iterator(sv, width);
+	}
+
+	constexpr auto end() const -> std::default_sentinel_t {
+		return std::default_sentinel;
+	}
+
+private:
+	std::string_view sv;
+	std::size_t width = 0;
+};
+
 /// @brief Word wrap `sv` to `width`.
 ///
 /// Attempt to break `sv` into substrings (lines) that are length `width`
 /// or shorter. Breaks only at spaces. If a line ends up being longer
-/// than `width`, yet contains no spaces, it is added as is.
+/// than `width`, yet contains no spaces, it is added as is. Leading
+/// space is skipped.
 ///
-/// @note Ensure that the returned vector of string_views does not
-/// outlive the data `sv` points to.
+/// Returns a lazy view of the lines, which finds spaces eight characters
+/// at a time on little-endian targets.
+///
+///     for (auto line : cpparg::word_wrap(text, 72)) {
+///         std::println("{}", line);
+///     }
+///
+/// @note Ensure that the returned view does not outlive the data `sv`
+/// points to.
 ///
 /// @param sv string to wrap
 /// @param width line width
-/// @return vector of substrings (lines)
-constexpr auto word_wrap(std::string_view sv, std::size_t width) {
-	std::vector<std::string_view> res;
+/// @return view of substrings (lines)
+constexpr auto word_wrap(std::string_view sv, std::size_t width) -> WordWrapView {
+	return WordWrapView(sv, width);
+}
+
+static_assert(std::ranges::forward_range<WordWrapView>);
+static_assert(std::ranges::distance(word_wrap("", 10)) == 1);
+static_assert(std::ranges::distance(word_wrap("  one two  three ", 7)) == 2);
+
+namespace detail {
+
+/// @brief Write `arg_name` adjusted for use in option help to `out`.
+///
+/// @param arg_name option argument name as given to `add_option`
+/// @param has_long_flag true if the option has a long flag
+/// @param out output iterator
+/// @return output iterator past the last character written
+template<std::output_iterator<char> O>
+constexpr auto write_help_arg_name(std::string_view arg_name, bool has_long_flag, O out) -> O {
+	if (arg_name.starts_with('=')) {
+		// Required argument starting with '='
+		if (!has_long_flag) {
+			// No long flag, remove '=' so -f=ARG becomes -fARG
+			arg_name.remove_prefix(1);
+		}
+	}
+	else if (arg_name.starts_with('[')) {
+		// Optional argument
+		if (!has_long_flag) {
+			// No long flag, remove any '=' so -f[=ARG] becomes -f[ARG]
+			if (arg_name.starts_with("[=")) {
+				*out++ = '[';
+				arg_name.remove_prefix(2);
+			}
+		}
+		else {
+			// Long flag, add '=' so --foo[ARG] becomes --foo[=ARG]
+			if (!arg_name.starts_with("[=")) {
+				*out++ = '[';
+				*out++ = '=';
+				arg_name.remove_prefix(1);
+			}
+		}
+	}
+	else if (!arg_name.empty()) {
+		// Required argument not starting with '=', insert space
+		// so -fARG becomes -f ARG and --fooARG becomes --foo ARG
+		*out++ = ' ';
+	}
+
+	return std::ranges::copy(arg_name, out).out;
+}
+
+/// @brief Write help text for `options` to `out`.
+///
+/// Each element of `options` must have the members `short_flag`,
+/// `long_flag`, `arg_name` and `description`, convertible to
+/// `std::string_view`.
+///
+/// If `out` has a member function `write(std::string_view)`, strings are
+/// written with it instead of one character at a time.
+///
+/// @param options range of options
+/// @param line_width width to word wrap lines at, or 0 to disable
+/// @param out output iterator
+/// @return output iterator past the last character written
+template<std::ranges::input_range R, std::output_iterator<char> O>
+constexpr auto write_option_help(const R &options, std::size_t line_width, O out) -> O {
+	// Help for each option consists of flags and description.
+	// This is a limit for how long the flags part can be.
+	// Options that exceed this will have their description
+	// start on the next line.
+	constexpr std::size_t flags_len_limit = 29;
+
+	std::size_t longest_flags = 0;
+
+	for (const auto &option : options) {
+		// Length of "  -f, --" plus long name
+		std::size_t len = 8 + std::string_view(option.long_flag).size();
+
+		len += std::string_view(option.arg_name).size();
+
+		// Two spaces before description
+		len += 2;
+
+		longest_flags = std::max(longest_flags, len);
+	}
 
-	auto is_space = [](char ch) { return ch == ' '; };
+	std::size_t flags_len = std::min(flags_len_limit, longest_flags);
 
-	// Skip leading space
-	auto line_start = std::find_if_not(sv.begin(), sv.end(), is_space);
+	// Adjust line width to at least flags_len
+	if (line_width && line_width < flags_len) {
+		line_width = flags_len;
+	}
+
+	auto append = [&](std::string_view sv) {
+		if constexpr (requires { out.write(sv); }) {
+			out.write(sv);
+		}
+		else {
+			out = std::ranges::copy(sv, std::move(out)).out;
+		}
+	};
 
-	auto space_begin = std::find_if(line_start, sv.end(), is_space);
+	auto append_spaces = [&](std::size_t count) {
+		if constexpr (requires { out.write(std::string_view()); }) {
+			constexpr std::string_view spaces("                                ");
 
-	while (space_begin != sv.end()) {
-		auto space_end = std::find_if_not(space_begin, sv.end(), is_space);
+			for (; count > spaces.size(); count -= spaces.size()) {
+				out.write(spaces);
+			}
 
-		auto next_space_begin = std::find_if(space_end, sv.end(), is_space);
+			out.write(spaces.substr(0, count));
+		}
+		else {
+			out = std::ranges::fill_n(std::move(out), static_cast<std::ptrdiff_t>(count), ' ');
+		}
+	};
 
-		// If breaking at the next space would exceed width, break here
-		if (next_space_begin - line_start > width) {
-			res.emplace_back(line_start, space_begin);
+	for (const auto &option : options) {
+		std::string_view short_flag(option.short_flag);
+		std::string_view long_flag(option.long_flag);
+		std::string_view arg_name(option.arg_name);
+		std::string_view description(option.description);
 
-			line_start = space_end;
+		// Omit options marked as hidden
+		if (description.starts_with("[hidden]")) {
+			continue;
 		}
 
-		space_begin = next_space_begin;
-	}
+		// Length of the flags part written so far
+		std::size_t line_len = 4;
+
+		// Add short flag or space
+		if (short_flag.empty()) {
+			append("    ");
+		}
+		else {
+			append("  -");
+			append(short_flag);
+			line_len = 3 + short_flag.size();
+		}
+
+		// Add long flag if present
+		if (!long_flag.empty() && long_flag != short_flag) {
+			append(short_flag.empty() ? "  --" : ", --");
+			append(long_flag);
+			line_len += 4 + long_flag.size();
+		}
+
+		// Add option argument
+		append(arg_name);
+		line_len += arg_name.size();
+
+		// The flags part of the option is done now. We need
+		// to format the description, starting with any
+		// leading space to align all the descriptions, or
+		// possibly a newline if the flags part was too long.
+
+		if (description.empty()) {
+			append("\n");
+
+			continue;
+		}
+
+		// Find leading space before description for first line
+		std::size_t leading_space = flags_len;
+
+		if (line_len + 2 > flags_len) {
+			append("\n");
+		}
+		else {
+			leading_space = flags_len - line_len;
+		}
 
-	if (line_start != sv.end() || sv.empty()) {
-		res.emplace_back(line_start, sv.end());
+		// Add description
+		if (line_width) {
+			for (auto line : word_wrap(description, line_width - flags_len)) {
+				append_spaces(leading_space);
+				append(line);
+				append("\n");
+
+				leading_space = flags_len;
+			}
+		}
+		else {
+			append_spaces(leading_space);
+			append(description);
+			append("\n");
+		}
 	}
 
-	return res;
+	return out;
 }
 
 constexpr auto to_lower(char ch) -> char {
@@ -106,9 +487,41 @@ constexpr auto iequal(std::string_view lhs, std::string_view rhs) -> bool {
 	);
 }
 
+/// @brief Transparent string hash for heterogeneous lookup.
+struct string_hash {
+	using is_transparent = void;
+
+	auto operator()(std::string_view sv) const noexcept -> std::size_t {
+		return std::hash<std::string_view>{}(sv);
+	}
+};
+
 template<typename T>
 concept NonBoolIntegral = std::integral<T> && !std::same_as<std::remove_cv_t<T>, bool>;
 
+/// @brief Iterators to arguments that can be viewed as `std::string_view`.
+///
+/// Dereferencing must not return an object owning the characters, like a
+/// `std::string` by value, since views of it would dangle.
+template<typename I>
+concept ArgumentIterator = std::forward_iterator<I>
+                        && std::convertible_to<std::iter_reference_t<I>, std::string_view>
+                        && (std::is_reference_v<std::iter_reference_t<I>>
+                            || std::is_pointer_v<std::iter_reference_t<I>>
+                            || std::ranges::borrowed_range<std::iter_reference_t<I>>);
+
+/// @brief Types a variable bound to an option can have.
+template<typename T>
+concept Bindable = !std::is_const_v<T>
+                && (std::integral<T> || std::floating_point<T> || std::assignable_from<T &, std::string_view>);
+
+/// @brief Conversion of option arguments to a bound variable of type `T`.
+template<Bindable T>
+struct Binder;
+
+template<typename Derived>
+class OptionParserBase;
+
 } // namespace detail
 
 struct ParseError {
@@ -116,34 +529,151 @@ struct ParseError {
 	std::string what;
 };
 
-struct ParsedOption {
-	explicit ParsedOption(std::string_view name) : name(name) {}
-	std::string name;
+// Defined with the other conversions, used for environment variables
+template<typename T>
+	requires std::same_as<std::remove_cv_t<T>, bool>
+constexpr auto convert_to(std::string_view sv) -> std::expected<T, std::errc>;
+
+/// @brief Handle identifying an option of an `OptionParser`.
+///
+/// Querying a `ParseResult` with an `OptionId` is a single indexed load,
+/// instead of a hash lookup of the option name.
+struct OptionId {
+	std::size_t index = std::numeric_limits<std::size_t>::max();
+
+	auto operator<=>(const OptionId &) const = default;
+};
+
+/// @brief Kind of `ParseEvent`.
+enum struct ParseEventKind {
+	option,
+	positional
+};
+
+/// @brief Option occurence or positional argument found during parsing.
+///
+/// For an option, `option_id` and `name` identify the option, and
+/// `argument` contains the option argument, if any. For a positional
+/// argument, `argument` contains it.
+///
+/// `argv_index` is the index of the element the event originated from.
+struct ParseEvent {
+	ParseEventKind kind = ParseEventKind::positional;
+	OptionId option_id;
+	std::string_view name;
+	std::optional<std::string_view> argument;
+	std::size_t argv_index = 0;
+};
+
+/// @brief Return value of visitor passed to `parse_with()`.
+enum struct ParseControl {
+	proceed,
+	stop
+};
+
+template<typename Parser, std::forward_iterator I>
+class ParseEventRange;
+
+/// @brief Option that occured during parsing.
+///
+/// `StringT` is the type used to store the name and option arguments,
+/// either `std::string` or `std::string_view` (or another
+/// `std::basic_string` using `Allocator`).
+///
+/// `Allocator` is used for all memory allocated by the option.
+template<typename StringT, typename Allocator = std::allocator<char>>
+struct BasicParsedOption {
+	explicit BasicParsedOption(std::string_view name, const Allocator &alloc = Allocator())
+		: name(std::make_obj_using_allocator<StringT>(alloc, name)), arguments(alloc) {}
+	StringT name;
 	std::size_t count = 0;
-	std::vector<std::string> arguments;
+	std::vector<StringT, typename std::allocator_traits<Allocator>::template rebind_alloc<StringT>> arguments;
 };
 
-class ParseResult {
+/// @brief Result of parsing.
+///
+/// `StringT` is the type used to store option names and arguments. With
+/// `std::string` the result owns copies of them. With `std::string_view`
+/// no copies are made, and the result refers to the parsed elements and
+/// the option names of the `OptionParser` directly.
+///
+/// `Allocator` is used for all memory allocated by the result, which
+/// makes it possible to use a `std::pmr::memory_resource` like an arena
+/// for a parse, see `cpparg::pmr::ParseResult`.
+template<typename StringT, typename Allocator = std::allocator<char>>
+class BasicParseResult {
+	template<typename T>
+	using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
 public:
+	using string_type = StringT;
+	using allocator_type = Allocator;
+	using parsed_option_type = BasicParsedOption<StringT, Allocator>;
+	using string_vector = std::vector<StringT, rebind_alloc<StringT>>;
+
+	BasicParseResult() = default;
+
+	explicit BasicParseResult(const allocator_type &alloc)
+		: lookup(alloc), id_lookup(alloc), parsed_options(alloc), spare_options(alloc), positional_args(alloc) {}
+
+	/// @brief Copy `other` using `alloc`.
+	///
+	/// Only the parsed options and arguments are copied, not the memory
+	/// `other` keeps for reuse by `clear()`, so the copy is compact.
+	BasicParseResult(const BasicParseResult &other, const allocator_type &alloc)
+		: BasicParseResult(alloc) {
+		parsed_options.reserve(other.parsed_options.size());
+
+		for (const auto &option : other.parsed_options) {
+			auto &copy = parsed_options.emplace_back(std::string_view(option.name), alloc);
+
+			copy.count = option.count;
+			copy.arguments.assign(option.arguments.begin(), option.arguments.end());
+		}
+
+		lookup.reserve(other.parsed_options.size());
+
+		for (const auto &[name, entry] : other.lookup) {
+			if (entry.generation == other.generation) {
+				lookup.emplace(lookup_key(name, alloc), entry);
+			}
+		}
+
+		id_lookup.assign(other.id_lookup.begin(), other.id_lookup.end());
+		positional_args.assign(other.positional_args.begin(), other.positional_args.end());
+		storage = other.storage;
+		generation = other.generation;
+
+		if (other.subcommand_name) {
+			subcommand_name.emplace(std::make_obj_using_allocator<StringT>(alloc, *other.subcommand_name));
+			subcommand_result = std::make_shared<BasicParseResult>(*other.subcommand_result, alloc);
+		}
+	}
+
+	/// @brief Get allocator used by result.
+	auto get_allocator() const -> allocator_type {
+		return allocator_type(parsed_options.get_allocator());
+	}
+
 	/// @brief Check if option `name` occured.
 	auto contains(std::string_view name) const -> bool {
-		return lookup.contains(std::string(name));
+		return find_parsed_option(name) != nullptr;
 	}
 
 	/// @brief Get number of times option `name` occured.
 	auto count(std::string_view name) const -> std::size_t {
-		if (auto it = lookup.find(std::string(name)); it != lookup.end()) {
-			return parsed_options[it->second].count;
+		if (auto *option = find_parsed_option(name)) {
+			return option->count;
 		}
 
 		return 0;
 	}
 
 	/// @brief Get last option argument for option `name`.
-	auto get_last_argument_for_option(std::string_view name) const -> std::optional<std::string> {
-		if (auto it = lookup.find(std::string(name)); it != lookup.end()) {
-			if (!parsed_options[it->second].arguments.empty()) {
-				return parsed_options[it->second].arguments.back();
+	auto get_last_argument_for_option(std::string_view name) const -> std::optional<StringT> {
+		if (auto *option = find_parsed_option(name)) {
+			if (!option->arguments.empty()) {
+				return option->arguments.back();
 			}
 		}
 
@@ -151,45 +681,137 @@ public:
 	}
 
 	/// @brief Access vector of option arguments for option `name`.
-	auto get_arguments_for_option(std::string_view name) const -> const std::vector<std::string>& {
-		if (auto it = lookup.find(std::string(name)); it != lookup.end()) {
-			return parsed_options[it->second].arguments;
+	auto get_arguments_for_option(std::string_view name) const -> const string_vector& {
+		if (auto *option = find_parsed_option(name)) {
+			return option->arguments;
+		}
+
+		return empty_arguments;
+	}
+
+	/// @brief Check if option `id` occured.
+	auto contains(OptionId id) const -> bool {
+		return find_parsed_option(id) != nullptr;
+	}
+
+	/// @brief Get number of times option `id` occured.
+	auto count(OptionId id) const -> std::size_t {
+		if (auto *option = find_parsed_option(id)) {
+			return option->count;
+		}
+
+		return 0;
+	}
+
+	/// @brief Get last option argument for option `id`.
+	auto get_last_argument_for_option(OptionId id) const -> std::optional<StringT> {
+		if (auto *option = find_parsed_option(id)) {
+			if (!option->arguments.empty()) {
+				return option->arguments.back();
+			}
+		}
+
+		return {};
+	}
+
+	/// @brief Access vector of option arguments for option `id`.
+	auto get_arguments_for_option(OptionId id) const -> const string_vector& {
+		if (auto *option = find_parsed_option(id)) {
+			return option->arguments;
 		}
 
 		return empty_arguments;
 	}
 
-	/// @brief Access vector of `ParsedOption`.
-	auto get_parsed_options() const -> const std::vector<ParsedOption>& {
+	/// @brief Remove all parsed options and positional arguments.
+	///
+	/// Keeps the memory allocated for them, so parsing into the result
+	/// again only allocates if it needs more than before. Option
+	/// arguments and positional arguments that are owning strings longer
+	/// than the small string buffer are still allocated each time.
+	auto clear() -> void {
+		// Start new generation, making all lookup entries stale
+		++generation;
+
+		// Keep parsed options for reuse, in reverse so options that
+		// occur in the same order next time get the same object
+		spare_options.reserve(spare_options.size() + parsed_options.size());
+
+		for (auto &option : parsed_options | std::views::reverse) {
+			option.count = 0;
+			option.arguments.clear();
+			spare_options.push_back(std::move(option));
+		}
+
+		parsed_options.clear();
+		positional_args.clear();
+		storage.reset();
+		subcommand_name.reset();
+	}
+
+	/// @brief Access vector of `BasicParsedOption`.
+	auto get_parsed_options() const -> const std::vector<parsed_option_type, rebind_alloc<parsed_option_type>>& {
 		return parsed_options;
 	}
 
 	/// @brief Access vector of positional arguments.
-	auto get_positional_arguments() const -> const std::vector<std::string>& {
+	auto get_positional_arguments() const -> const string_vector& {
 		return positional_args;
 	}
 
-	/// @brief Add occurence of parsed option `name`.
-	auto add_parsed_option(std::string_view name) -> void {
-		auto [it, inserted] = lookup.emplace(std::string(name), parsed_options.size());
+	/// @brief Get name of subcommand, if any.
+	auto get_subcommand() const -> std::optional<StringT> {
+		return subcommand_name;
+	}
 
-		if (inserted) {
-			parsed_options.emplace_back(name);
+	/// @brief Get result of parsing the arguments after the subcommand.
+	/// @return pointer to result, nullptr if there is no subcommand
+	auto get_subcommand_result() const -> const BasicParseResult * {
+		return subcommand_name ? subcommand_result.get() : nullptr;
+	}
+
+	/// @brief Set subcommand `name`, and get result for its arguments.
+	///
+	/// The result for the subcommand arguments is cleared, and reused if
+	/// not shared with a copy of this.
+	auto set_subcommand(std::string_view name) -> BasicParseResult& {
+		subcommand_name.emplace(std::make_obj_using_allocator<StringT>(get_allocator(), name));
+
+		if (subcommand_result && subcommand_result.use_count() == 1) {
+			subcommand_result->clear();
 		}
+		else {
+			subcommand_result = std::make_shared<BasicParseResult>(get_allocator());
+		}
+
+		return *subcommand_result;
+	}
 
-		parsed_options[it->second].count++;
+	/// @brief Add occurence of parsed option `name`.
+	auto add_parsed_option(std::string_view name) -> void {
+		find_or_add_parsed_option(name).count++;
 	}
 
 	/// @brief Add occurence of parsed option `name` with argument `argument`.
 	auto add_parsed_option(std::string_view name, std::string_view argument) -> void {
-		auto [it, inserted] = lookup.emplace(std::string(name), parsed_options.size());
+		auto &option = find_or_add_parsed_option(name);
 
-		if (inserted) {
-			parsed_options.emplace_back(name);
-		}
+		option.count++;
+		option.arguments.emplace_back(argument);
+	}
 
-		parsed_options[it->second].count++;
-		parsed_options[it->second].arguments.emplace_back(argument);
+	/// @brief Add occurence of parsed option `name` with id `id`.
+	auto add_parsed_option(OptionId id, std::string_view name) -> void {
+		find_or_add_parsed_option(id, name).count++;
+	}
+
+	/// @brief Add occurence of parsed option `name` with id `id` and
+	/// argument `argument`.
+	auto add_parsed_option(OptionId id, std::string_view name, std::string_view argument) -> void {
+		auto &option = find_or_add_parsed_option(id, name);
+
+		option.count++;
+		option.arguments.emplace_back(argument);
 	}
 
 	/// @brief Add positional argument.
@@ -199,96 +821,1922 @@ public:
 
 	/// @brief Add positional arguments from range [first, last).
 	template<std::input_iterator I, std::sentinel_for<I> S>
-		requires std::convertible_to<std::iter_reference_t<I>, std::string>
+		requires std::convertible_to<std::iter_reference_t<I>, std::string_view>
 	auto add_positional_arguments(I first, S last) -> void {
-		positional_args.insert(positional_args.end(), first, last);
+		if constexpr (std::sized_sentinel_for<S, I>) {
+			positional_args.reserve(positional_args.size() + (last - first));
+		}
+
+		for (; first != last; ++first) {
+			positional_args.emplace_back(std::string_view(*first));
+		}
 	}
 
 private:
-	std::unordered_map<std::string, std::size_t> lookup;
-	std::vector<ParsedOption> parsed_options;
-	std::vector<std::string> positional_args;
-	inline static const std::vector<std::string> empty_arguments;
-};
+	// Index into parsed_options, valid if generation matches the
+	// generation of the result
+	struct LookupEntry {
+		std::size_t index = 0;
+		std::size_t generation = 0;
+	};
 
-class OptionParser {
-	struct Option {
-		std::string short_flag;
-		std::string long_flag;
-		std::string arg_name;
-		std::string description;
+	// Keys are owned, since entries are kept by clear() and a view of an
+	// option name could dangle when the result is reused
+	using lookup_key = std::basic_string<char, std::char_traits<char>, rebind_alloc<char>>;
+
+	std::unordered_map<lookup_key, LookupEntry, detail::string_hash, std::equal_to<>,
+		rebind_alloc<std::pair<const lookup_key, LookupEntry>>> lookup;
+	std::vector<LookupEntry, rebind_alloc<LookupEntry>> id_lookup;
+	std::vector<parsed_option_type, rebind_alloc<parsed_option_type>> parsed_options;
+	// Parsed options kept by clear() for reuse
+	std::vector<parsed_option_type, rebind_alloc<parsed_option_type>> spare_options;
+	string_vector positional_args;
+	// Keeps contents of response files alive when referred to
+	std::shared_ptr<const void> storage;
+	std::optional<StringT> subcommand_name;
+	// Kept by clear() for reuse, shared by copies until one reuses it
+	std::shared_ptr<BasicParseResult> subcommand_result;
+	std::size_t generation = 1;
+	inline static const string_vector empty_arguments;
+
+	template<typename Derived>
+	friend class detail::OptionParserBase;
+
+	auto find_parsed_option(std::string_view name) const -> const parsed_option_type * {
+		if (auto it = lookup.find(name); it != lookup.end() && it->second.generation == generation) {
+			return &parsed_options[it->second.index];
+		}
 
-		auto takes_argument() const noexcept -> bool {
-			return !arg_name.empty();
+		return nullptr;
+	}
+
+	auto find_parsed_option(OptionId id) const -> const parsed_option_type * {
+		if (id.index < id_lookup.size() && id_lookup[id.index].generation == generation) {
+			return &parsed_options[id_lookup[id.index].index];
 		}
 
-		auto requires_argument() const noexcept -> bool {
-			return takes_argument() && !arg_name.starts_with('[');
+		return nullptr;
+	}
+
+	auto find_or_add_parsed_option(std::string_view name) -> parsed_option_type & {
+		auto it = lookup.find(name);
+
+		if (it == lookup.end()) {
+			it = lookup.emplace(lookup_key(name, get_allocator()), LookupEntry{}).first;
 		}
-	};
 
-public:
-	/// @brief Add option.
-	///
-	/// If `arg_name` is enclosed in square brackets, like "[ARG]", the
-	/// option argument is optional. Otherwise it is required.
-	///
-	/// By default, required arguments are printed as separate elements
-	/// in option help. You can change this by adding a '=' to `arg_name`.
-	///
-	///     "f" "foo" "ARG"  becomes -f, --foo ARG
-	///     "f" ""    "ARG"  becomes -f ARG
-	///     "f" "foo" "=ARG" becomes -f, --foo=ARG
-	///     "f" ""    "=ARG" becomes -fARG
-	///
+		auto &entry = it->second;
+
+		if (entry.generation != generation) {
+			entry = {parsed_options.size(), generation};
+
+			if (spare_options.empty()) {
+				parsed_options.emplace_back(name, get_allocator());
+			}
+			else {
+				parsed_options.push_back(std::move(spare_options.back()));
+				spare_options.pop_back();
+				parsed_options.back().name = name;
+			}
+		}
+
+		return parsed_options[entry.index];
+	}
+
+	auto find_or_add_parsed_option(OptionId id, std::string_view name) -> parsed_option_type & {
+		if (id.index >= id_lookup.size()) {
+			id_lookup.resize(id.index + 1);
+		}
+
+		auto &entry = id_lookup[id.index];
+
+		if (entry.generation != generation) {
+			auto &option = find_or_add_parsed_option(name);
+
+			entry = {static_cast<std::size_t>(&option - parsed_options.data()), generation};
+		}
+
+		return parsed_options[entry.index];
+	}
+};
+
+using ParsedOption = BasicParsedOption<std::string>;
+using ParsedOptionView = BasicParsedOption<std::string_view>;
+
+/// @brief Result of parsing that owns copies of names and arguments.
+using ParseResult = BasicParseResult<std::string>;
+
+/// @brief Result of parsing that refers to names and arguments.
+///
+/// @note Ensure that a `ParseResultView` does not outlive the elements
+/// that were parsed, or the `OptionParser` that parsed them.
+using ParseResultView = BasicParseResult<std::string_view>;
+
+namespace detail {
+
+/// @brief Read remaining contents of `f` into `out`.
+inline auto read_stream(std::FILE *f, std::string &out) -> bool {
+	std::array<char, 4096> buffer;
+
+	while (auto num_read = std::fread(buffer.data(), 1, buffer.size(), f)) {
+		out.append(buffer.data(), num_read);
+	}
+
+	return std::ferror(f) == 0;
+}
+
+/// @brief Writer of characters to a `FILE *` through a fixed buffer.
+class FileWriter {
+public:
+	/// @brief Output iterator putting characters in the buffer.
+	///
+	/// The iterator only refers to the writer, so copies of it can be
+	/// used interchangeably, like with `*it++ = c`.
+	class iterator {
+	public:
+		using difference_type = std::ptrdiff_t;
+
+		iterator() = default;
+
+		auto operator*() -> iterator & { return *this; }
+		auto operator++() -> iterator & { return *this; }
+		auto operator++(int) -> iterator { return *this; }
+
+		auto operator=(char c) -> iterator & {
+			writer->put(c);
+
+			return *this;
+		}
+
+		/// @brief Put all characters of `sv` in the buffer.
+		auto write(std::string_view sv) -> void {
+			writer->write(sv);
+		}
+
+	private:
+		friend FileWriter;
+
+		FileWriter *writer = nullptr;
+
+		explicit iterator(FileWriter &writer) : writer(&writer) {}
+	};
+
+	explicit FileWriter(std::FILE *f) : f(f) {}
+
+	FileWriter(const FileWriter &) = delete;
+	auto operator=(const FileWriter &) -> FileWriter & = delete;
+
+	auto begin() -> iterator {
+		return iterator(*this);
+	}
+
+	/// @brief Write buffered characters to file.
+	/// @return true if all writes succeeded, false otherwise
+	auto flush() -> bool {
+		write_buffer();
+
+		return !failed;
+	}
+
+private:
+	std::FILE *f;
+	std::array<char, 4096> buffer;
+	std::size_t size = 0;
+	bool failed = false;
+
+	auto put(char c) -> void {
+		if (size == buffer.size()) {
+			write_buffer();
+		}
+
+		buffer[size++] = c;
+	}
+
+	auto write(std::string_view sv) -> void {
+		while (sv.size() > buffer.size() - size) {
+			auto n = buffer.size() - size;
+
+			std::ranges::copy(sv.substr(0, n), buffer.data() + size);
+			size += n;
+			sv.remove_prefix(n);
+
+			write_buffer();
+		}
+
+		std::ranges::copy(sv, buffer.data() + size);
+		size += sv.size();
+	}
+
+	auto write_buffer() -> void {
+		if (size != 0 && std::fwrite(buffer.data(), 1, size, f) != size) {
+			failed = true;
+		}
+
+		size = 0;
+	}
+};
+
+#if !defined(_WIN32)
+// Declared here rather than globally, with C linkage it is the same object
+extern "C" char **environ;
+#endif
+
+/// @brief Get environment variables of the process.
+inline auto environment() -> const char * const * {
+#if defined(_WIN32)
+	return _environ;
+#else
+	return environ;
+#endif
+}
+
+/// @brief Writable private view of the contents of a file.
+///
+/// If `CPPARG_USE_MMAP` is defined, regular files on POSIX systems are
+/// memory mapped copy-on-write, so changes are not written back and only
+/// the pages changed are copied. Other files are read into memory.
+class MappedFile {
+public:
+	MappedFile() = default;
+
+	MappedFile(const MappedFile &) = delete;
+	auto operator=(const MappedFile &) -> MappedFile & = delete;
+
+	MappedFile(MappedFile &&other) noexcept
+		: contents(std::move(other.contents)),
+		  map_data(std::exchange(other.map_data, nullptr)),
+		  map_size(std::exchange(other.map_size, 0)) {}
+
+	auto operator=(MappedFile &&other) noexcept -> MappedFile & {
+		std::swap(contents, other.contents);
+		std::swap(map_data, other.map_data);
+		std::swap(map_size, other.map_size);
+
+		return *this;
+	}
+
+	~MappedFile() {
+#if defined(CPPARG_USE_MMAP) && !defined(_WIN32)
+		if (map_data != nullptr) {
+			::munmap(map_data, map_size);
+		}
+#endif
+	}
+
+	/// @brief Open file at `path`, storing a string identifying the file
+	/// in `id`.
+	/// @return true on success, false if file could not be opened
+	auto open(const char *path, std::string &id) -> bool {
+#if !defined(CPPARG_USE_MMAP) || defined(_WIN32)
+		std::FILE *f = std::fopen(path, "rb");
+
+		if (f == nullptr) {
+			return false;
+		}
+
+		std::error_code ec;
+
+		id = std::filesystem::weakly_canonical(path, ec).string();
+
+		return read_contents(f);
+#else
+		int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat st;
+
+		if (::fstat(fd, &st) != 0) {
+			::close(fd);
+
+			return false;
+		}
+
+		id = std::format("{}:{}", st.st_dev, st.st_ino);
+
+		if (!S_ISREG(st.st_mode)) {
+			std::FILE *f = ::fdopen(fd, "rb");
+
+			if (f == nullptr) {
+				::close(fd);
+
+				return false;
+			}
+
+			return read_contents(f);
+		}
+
+		if (st.st_size > 0) {
+			auto size = static_cast<std::size_t>(st.st_size);
+
+			void *p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+			if (p == MAP_FAILED) {
+				::close(fd);
+
+				return false;
+			}
+
+			map_data = static_cast<char *>(p);
+			map_size = size;
+		}
+
+		::close(fd);
+
+		return true;
+#endif
+	}
+
+	auto data() -> char * {
+		return contents ? contents->data() : map_data;
+	}
+
+	auto size() const -> std::size_t {
+		return contents ? contents->size() : map_size;
+	}
+
+private:
+	// Contents of file if read into memory, held by pointer so data()
+	// is stable when moved
+	std::unique_ptr<std::string> contents;
+	char *map_data = nullptr;
+	std::size_t map_size = 0;
+
+	auto read_contents(std::FILE *f) -> bool {
+		contents = std::make_unique<std::string>();
+
+		bool ok = read_stream(f, *contents);
+
+		std::fclose(f);
+
+		return ok;
+	}
+};
+
+constexpr auto is_response_file_space(char c) -> bool {
+	return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/// @brief Split response file contents in [p, end) into arguments.
+///
+/// If the contents contain a NUL character, arguments are separated by
+/// NUL characters. Otherwise arguments are separated by whitespace, and
+/// quoting works like in GCC: single and double quotes group characters,
+/// and backslash escapes the next character. Arguments are unescaped in
+/// place, and characters are only written when they move.
+///
+/// Calls `fn` with a `std::string_view` for each argument.
+template<typename Fn>
+auto split_response_file(char *p, char *end, Fn &&fn) -> void {
+	std::string_view contents(p, static_cast<std::size_t>(end - p));
+
+	if (contents.find('\0') != std::string_view::npos) {
+		while (!contents.empty()) {
+			auto arg_end = contents.find('\0');
+
+			fn(contents.substr(0, arg_end));
+
+			if (arg_end == std::string_view::npos) {
+				break;
+			}
+
+			contents.remove_prefix(arg_end + 1);
+		}
+
+		return;
+	}
+
+	for (;;) {
+		while (p != end && is_response_file_space(*p)) {
+			++p;
+		}
+
+		if (p == end) {
+			break;
+		}
+
+		char *start = p;
+		char *out = p;
+		char quote = 0;
+
+		for (; p != end; ++p) {
+			char c = *p;
+
+			if (c == '\\' && p + 1 != end) {
+				c = *++p;
+			}
+			else if (quote != 0) {
+				if (c == quote) {
+					quote = 0;
+					continue;
+				}
+			}
+			else if (c == '\'' || c == '"') {
+				quote = c;
+				continue;
+			}
+			else if (is_response_file_space(c)) {
+				break;
+			}
+
+			if (out != p) {
+				*out = c;
+			}
+
+			++out;
+		}
+
+		fn(std::string_view(start, static_cast<std::size_t>(out - start)));
+	}
+}
+
+/// @brief Line of a config file.
+struct ConfigLine {
+	enum struct Kind { empty, section, entry };
+
+	Kind kind = Kind::empty;
+	std::string_view name;
+	std::optional<std::string_view> value;
+};
+
+constexpr auto trim_config_space(std::string_view sv) -> std::string_view {
+	auto first = sv.find_first_not_of(" \t\r");
+
+	if (first == std::string_view::npos) {
+		return {};
+	}
+
+	return sv.substr(first, sv.find_last_not_of(" \t\r") - first + 1);
+}
+
+/// @brief Split `line` of a config file into option name and value.
+///
+/// Lines are either blank, comments starting with '#' or ';', section
+/// headers in square brackets, or an option name optionally preceded by
+/// "--" and followed by a value, separated by '=' and/or whitespace. A
+/// value enclosed in double quotes has the quotes removed.
+constexpr auto split_config_line(std::string_view line) -> ConfigLine {
+	line = trim_config_space(line);
+
+	if (line.empty() || line.starts_with('#') || line.starts_with(';')) {
+		return {};
+	}
+
+	if (line.starts_with('[')) {
+		return {ConfigLine::Kind::section, line, {}};
+	}
+
+	if (line.starts_with("--")) {
+		line.remove_prefix(2);
+	}
+
+	auto name_end = line.find_first_of("= \t");
+
+	if (name_end == std::string_view::npos) {
+		return {ConfigLine::Kind::entry, line, {}};
+	}
+
+	auto value = trim_config_space(line.substr(name_end));
+
+	if (value.starts_with('=')) {
+		value = trim_config_space(value.substr(1));
+	}
+
+	if (value.size() >= 2 && value.starts_with('"') && value.ends_with('"')) {
+		value = value.substr(1, value.size() - 2);
+	}
+
+	return {ConfigLine::Kind::entry, line.substr(0, name_end), value};
+}
+
+static_assert(split_config_line(" # comment").kind == ConfigLine::Kind::empty);
+static_assert(split_config_line("--verbose").name == "verbose");
+static_assert(split_config_line("threads = 4\r").value == "4");
+static_assert(split_config_line("output \"a b\"").value == "a b");
+
+} // namespace detail
+
+/// @brief Arguments with response files expanded.
+///
+/// An argument of the form "@file" is replaced by the arguments read from
+/// `file`, see `expand()`. The arguments refer to the original elements
+/// and to the contents of the files, which are kept alive by this.
+class ResponseFileArgs {
+public:
+	/// @brief Expand response files in range [first, last).
+	///
+	/// Each element of the form "@file" is replaced by the arguments in
+	/// `file`, which are separated by whitespace (with quoting like GCC)
+	/// or by NUL characters. Response files in files are expanded
+	/// recursively. Relative paths are relative to the current directory.
+	/// If a file cannot be opened, the element is kept as is.
+	///
+	/// Files are read, or memory mapped where possible if
+	/// `CPPARG_USE_MMAP` is defined, and the arguments refer directly
+	/// into them.
+	///
+	/// @note Ensure that the result does not outlive the elements in
+	/// [first, last).
+	///
+	/// @return Arguments on success, ParseError if a response file
+	/// includes itself
+	template<detail::ArgumentIterator I>
+	static auto expand(I first, I last) -> std::expected<ResponseFileArgs, ParseError> {
+		ResponseFileArgs res;
+		std::vector<std::string> active_files;
+
+		for (std::size_t idx = 0; first != last; ++first, ++idx) {
+			if (auto added = res.add(std::string_view(*first), idx, active_files); !added) {
+				return std::unexpected(std::move(added.error()));
+			}
+		}
+
+		return res;
+	}
+
+	/// @brief Get expanded arguments.
+	auto args() const -> std::span<const std::string_view> {
+		return arguments;
+	}
+
+	/// @brief Get index of element that argument `index` originated from.
+	auto origin(std::size_t index) const -> std::size_t {
+		return origins[index];
+	}
+
+private:
+	std::vector<detail::MappedFile> files;
+	std::vector<std::string_view> arguments;
+	std::vector<std::size_t> origins;
+
+	auto add(std::string_view arg, std::size_t origin, std::vector<std::string> &active_files) -> std::expected<void, ParseError> {
+		if (arg.size() < 2 || arg.front() != '@') {
+			arguments.push_back(arg);
+			origins.push_back(origin);
+
+			return {};
+		}
+
+		std::string path(arg.substr(1));
+		std::string id;
+		detail::MappedFile file;
+
+		if (!file.open(path.c_str(), id)) {
+			arguments.push_back(arg);
+			origins.push_back(origin);
+
+			return {};
+		}
+
+		if (std::ranges::find(active_files, id) != active_files.end()) {
+			return std::unexpected<ParseError>(std::in_place, origin,
+				std::format("recursive response file '{}'", arg)
+			);
+		}
+
+		auto *data = file.data();
+		auto size = file.size();
+
+		files.push_back(std::move(file));
+		active_files.push_back(std::move(id));
+
+		std::expected<void, ParseError> res;
+
+		detail::split_response_file(data, data + size, [&](std::string_view file_arg) {
+			if (res) {
+				res = add(file_arg, origin, active_files);
+			}
+		});
+
+		active_files.pop_back();
+
+		return res;
+	}
+};
+
+namespace detail {
+
+/// @brief Parsing shared by `BasicOptionParser` and `StaticOptionParser`.
+///
+/// `Derived` provides lookup of options through the member functions
+/// `match_long_option`, `find_short_option` and `id_of`.
+template<typename Derived>
+class OptionParserBase {
+public:
+	/// @brief Cursor producing the events for a range of elements.
+	///
+	/// Each call to `next()` returns the next `ParseEvent`, a
+	/// `ParseError`, or nothing when all elements are parsed. The cursor
+	/// does not allocate, except when returning a `ParseError`.
+	template<std::forward_iterator I>
+	class Cursor {
+	public:
+		using result_type = std::expected<ParseEvent, ParseError>;
+
+		constexpr Cursor(const Derived &parser, I first, I last)
+			: parser(&parser), first(std::move(first)), last(std::move(last)) {}
+
+		/// @brief Get next event, or nothing if done.
+		auto next() -> std::optional<result_type> {
+			// Continue short option cluster from previous element
+			if (!cluster.empty()) {
+				return next_short_option();
+			}
+
+			while (first != last) {
+				std::string_view arg(*first);
+
+				// Check for nonoption element (including '-')
+				if (only_positional || !arg.starts_with('-') || arg == "-") {
+					return finish_element(ParseEvent{ParseEventKind::positional, {}, {}, arg, idx});
+				}
+
+				// Check for long option
+				if (arg.starts_with("--")) {
+					if (arg == "--") {
+						only_positional = true;
+
+						finish_element();
+
+						continue;
+					}
+
+					arg.remove_prefix(2);
+
+					return next_long_option(arg);
+				}
+
+				// Short option
+				cluster = arg.substr(1);
+				cluster_pos = 0;
+
+				return next_short_option();
+			}
+
+			return {};
+		}
+
+		/// @brief Get iterator to the next element to parse.
+		auto position() const -> const I & {
+			return first;
+		}
+
+		/// @brief Get index of the next element to parse.
+		auto index() const -> std::size_t {
+			return idx;
+		}
+
+		/// @brief Check if all remaining elements are positional
+		/// arguments, which is the case after "--".
+		auto positional_only() const -> bool {
+			return only_positional;
+		}
+
+		/// @brief Take the remaining elements, after which `next()`
+		/// returns nothing.
+		///
+		/// Once `positional_only()` is true, this allows handling the
+		/// remaining positional arguments in bulk.
+		auto take_remaining() -> std::ranges::subrange<I> {
+			cluster = {};
+
+			return {std::exchange(first, last), last};
+		}
+
+	private:
+		const Derived *parser;
+		I first;
+		I last;
+		std::size_t idx = 0;
+
+		// Remainder of short option element after '-', and position
+		// of next short option in it
+		std::string_view cluster;
+		std::size_t cluster_pos = 0;
+
+		bool only_positional = false;
+
+		auto finish_element() -> void {
+			++first;
+			++idx;
+			cluster = {};
+		}
+
+		auto finish_element(ParseEvent event) -> std::optional<result_type> {
+			finish_element();
+
+			return event;
+		}
+
+		auto fail(std::string what) -> std::optional<result_type> {
+			auto error_idx = idx;
+
+			// Any further calls return nothing
+			first = last;
+			cluster = {};
+
+			return std::unexpected<ParseError>(std::in_place, error_idx, std::move(what));
+		}
+
+		template<typename Option>
+		auto option_event(const Option *option, std::optional<std::string_view> argument = {}) const -> ParseEvent {
+			return {ParseEventKind::option, parser->id_of(option), option->long_flag, argument, idx};
+		}
+
+		auto next_long_option(std::string_view arg) -> std::optional<result_type> {
+			auto name_end = arg.find('=');
+
+			auto name = arg.substr(0, name_end);
+
+			auto match = parser->match_long_option(name, idx);
+
+			if (!match) {
+				first = last;
+
+				return std::unexpected(std::move(match.error()));
+			}
+
+			auto *option = *match;
+
+			if (option == nullptr) {
+				return fail(std::format("unrecognized long option '--{}'", name));
+			}
+
+			// Handle option argument included in element (--foo=argument)
+			if (name_end != std::string_view::npos) {
+				auto argument = arg.substr(name_end + 1);
+
+				if (!option->takes_argument()) {
+					return fail(std::format("extraneous argument in '--{}'", arg));
+				}
+
+				return finish_element(option_event(option, argument));
+			}
+
+			// No option argument in element, so if
+			// required take next element
+			if (option->requires_argument()) {
+				auto event = option_event(option);
+
+				if (++first == last) {
+					return fail(std::format("missing required argument for '--{}'", arg));
+				}
+
+				event.argument = std::string_view(*first);
+
+				++idx;
+
+				return finish_element(event);
+			}
+
+			// No option argument in element, none required
+			return finish_element(option_event(option));
+		}
+
+		auto next_short_option() -> std::optional<result_type> {
+			auto flag = cluster[cluster_pos];
+
+			auto *option = parser->find_short_option(flag);
+
+			if (option == nullptr) {
+				return fail(std::format("unrecognized short option '{}' in '-{}'", flag, cluster));
+			}
+
+			if (!option->takes_argument()) {
+				auto event = option_event(option);
+
+				if (++cluster_pos == cluster.size()) {
+					finish_element();
+				}
+
+				return event;
+			}
+
+			// If more characters, take as option argument
+			if (cluster_pos + 1 < cluster.size()) {
+				return finish_element(option_event(option, cluster.substr(cluster_pos + 1)));
+			}
+
+			if (!option->requires_argument()) {
+				return finish_element(option_event(option));
+			}
+
+			// Option argument required, so take next element
+			auto event = option_event(option);
+
+			if (++first == last) {
+				return fail(std::format("missing required argument for '{}' in '-{}'", flag, cluster));
+			}
+
+			event.argument = std::string_view(*first);
+
+			++idx;
+
+			return finish_element(event);
+		}
+	};
+
+	/// @brief Parse arguments in range [first, last).
+	///
+	/// The type of result can be selected with `Result`, for instance
+	/// `parse<ParseResultView>(first, last)` returns a result that refers
+	/// to the elements in [first, last) instead of copying them.
+	///
+	/// @param alloc allocator for the result
+	/// @return Result on success, ParseError otherwise
+	template<typename Result = ParseResult, detail::ArgumentIterator I>
+	auto parse(I first, I last, const typename Result::allocator_type &alloc = {}) const -> std::expected<Result, ParseError> {
+		Result res(alloc);
+
+		if (auto parsed = parse_into(res, std::move(first), std::move(last)); !parsed) {
+			return std::unexpected(std::move(parsed.error()));
+		}
+
+		return res;
+	}
+
+	/// @brief Parse arguments in range [first, last) into `res`.
+	///
+	/// `res` is cleared first, which keeps the memory it has allocated,
+	/// so reusing a result for many parses avoids allocating it again.
+	/// If an error occurs, `res` contains what was parsed before it.
+	///
+	/// @return nothing on success, ParseError otherwise
+	template<typename Result, detail::ArgumentIterator I>
+	auto parse_into(Result &res, I first, I last) const -> std::expected<void, ParseError> {
+		return parse_events_into<true>(res, std::move(first), std::move(last));
+	}
+
+	/// @brief Parse arguments in `argv`.
+	///
+	/// If the parser has an environment variable prefix, options not in
+	/// `argv` are added from the environment afterwards. For an invalid
+	/// environment variable, the `originating_arg` of the error is `argc`,
+	/// past the end of `argv`, and `what` names the variable.
+	///
+	/// @param alloc allocator for the result
+	/// @return Result on success, ParseError otherwise
+	template<typename Result = ParseResult>
+	auto parse_argv(int argc, const char * const argv[],
+	                const typename Result::allocator_type &alloc = {}) const -> std::expected<Result, ParseError> {
+		if (argc < 1) {
+			return std::unexpected<ParseError>(std::in_place, 0,
+				"argc less than 1"
+			);
+		}
+
+		auto has_response_file = [](const char *arg) {
+			return arg[0] == '@' && arg[1] != '\0';
+		};
+
+		// The environment is merged before variables bound to options in
+		// argv are set, so none are set if a variable is invalid
+		bool parsed = false;
+
+		auto merge_environment = [&](Result &res) {
+			parsed = true;
+
+			return self().apply_environment(res);
+		};
+
+		auto result = response_files && std::any_of(argv + 1, argv + argc, has_response_file)
+		            ? parse_response_files<Result>(argv + 1, argv + argc, alloc, merge_environment)
+		            : parse_before_binding<Result>(argv + 1, argv + argc, alloc, merge_environment);
+
+		if (!result) {
+			if (parsed) {
+				result.error().originating_arg = static_cast<std::size_t>(argc);
+			}
+			else {
+				result.error().originating_arg++;
+			}
+		}
+
+		return result;
+	}
+
+	/// @brief Allow response files in `parse_argv()`.
+	///
+	/// If enabled, elements of the form "@file" are replaced by the
+	/// arguments in `file`, see `ResponseFileArgs::expand()`. The
+	/// `originating_arg` of errors refers to the element in `argv`.
+	///
+	/// @param allow true to expand response files, false to not
+	/// @return reference to this, so calls can be chained
+	auto allow_response_files(bool allow = true) -> Derived & {
+		response_files = allow;
+
+		return static_cast<Derived &>(*this);
+	}
+
+	/// @brief Parse each command line in `command_lines`, in parallel.
+	///
+	/// Each element of `command_lines` is a range of arguments, like
+	/// [first, last) for `parse()`, for instance a `std::span` of the
+	/// elements of `argv` after the program name. The command lines are
+	/// divided into chunks, which `num_threads` threads take in turn.
+	/// Each thread parses into one result that it reuses, see
+	/// `parse_into()`, and copies it to the returned result. Variables
+	/// bound to options are not set.
+	///
+	/// @note `alloc` is used from all threads, so must be thread safe.
+	///
+	/// @param num_threads number of threads, 0 to use the hardware
+	/// concurrency
+	/// @param alloc allocator for the results
+	/// @return Result or ParseError for each command line, in order
+	template<typename Result = ParseResult, std::ranges::random_access_range R>
+		requires std::ranges::sized_range<R>
+		      && std::ranges::common_range<std::ranges::range_reference_t<R>>
+		      && detail::ArgumentIterator<std::ranges::iterator_t<std::ranges::range_reference_t<R>>>
+	auto parse_many(R &&command_lines, std::size_t num_threads = 0,
+	                const typename Result::allocator_type &alloc = {}) const -> std::vector<std::expected<Result, ParseError>> {
+		constexpr std::size_t chunk_size = 64;
+
+		auto num_lines = static_cast<std::size_t>(std::ranges::size(command_lines));
+		auto num_chunks = (num_lines + chunk_size - 1) / chunk_size;
+
+		std::vector<std::expected<Result, ParseError>> results(num_lines, std::expected<Result, ParseError>(std::unexpect));
+
+		std::atomic<std::size_t> next_chunk = 0;
+		std::exception_ptr exception;
+		std::atomic_flag failed;
+
+		auto parse_chunks = [&] {
+			try {
+				Result scratch(alloc);
+
+				for (;;) {
+					auto chunk = next_chunk.fetch_add(1, std::memory_order_relaxed);
+
+					if (chunk >= num_chunks) {
+						break;
+					}
+
+					auto chunk_end = std::min((chunk + 1) * chunk_size, num_lines);
+
+					for (auto i = chunk * chunk_size; i < chunk_end; ++i) {
+						auto &&line = std::ranges::begin(command_lines)[static_cast<std::ranges::range_difference_t<R>>(i)];
+
+						auto parsed = parse_events_into<false>(scratch, std::ranges::begin(line), std::ranges::end(line));
+
+						if (parsed) {
+							results[i] = std::expected<Result, ParseError>(std::in_place, scratch, alloc);
+						}
+						else {
+							results[i].error() = std::move(parsed.error());
+						}
+					}
+				}
+			}
+			catch (...) {
+				// Keep first exception and make other threads stop
+				if (!failed.test_and_set()) {
+					exception = std::current_exception();
+				}
+
+				next_chunk = num_chunks;
+			}
+		};
+
+		if (num_threads == 0) {
+			num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+		}
+
+		num_threads = std::min(num_threads, num_chunks);
+
+		if (num_threads <= 1) {
+			parse_chunks();
+		}
+		else {
+			std::vector<std::jthread> threads;
+
+			threads.reserve(num_threads - 1);
+
+			for (std::size_t i = 1; i < num_threads; ++i) {
+				threads.emplace_back(parse_chunks);
+			}
+
+			parse_chunks();
+		}
+
+		if (exception) {
+			std::rethrow_exception(exception);
+		}
+
+		return results;
+	}
+
+	/// @brief Parse arguments in range [first, last), calling `visitor`
+	/// for each event.
+	///
+	/// `visitor` is called with a `const ParseEvent &` for each option
+	/// occurence and positional argument, in the order they appear. It
+	/// may return `ParseControl::stop` to stop parsing. Nothing is
+	/// allocated, except for errors.
+	///
+	/// @return Iterator to the first element not completely parsed on
+	/// success, ParseError otherwise
+	template<detail::ArgumentIterator I, typename Visitor>
+		requires std::invocable<Visitor &, const ParseEvent &>
+	auto parse_with(I first, I last, Visitor &&visitor) const -> std::expected<I, ParseError> {
+		Cursor<I> cursor(self(), std::move(first), std::move(last));
+
+		while (auto event = cursor.next()) {
+			if (!*event) {
+				return std::unexpected(std::move(event->error()));
+			}
+
+			if constexpr (std::same_as<std::invoke_result_t<Visitor &, const ParseEvent &>, ParseControl>) {
+				if (std::invoke(visitor, std::as_const(**event)) == ParseControl::stop) {
+					break;
+				}
+			}
+			else {
+				std::invoke(visitor, std::as_const(**event));
+			}
+		}
+
+		return cursor.position();
+	}
+
+#if defined(__cpp_lib_generator)
+	/// @brief Parse arguments in range [first, last) lazily.
+	///
+	/// Returns a `std::generator` that yields a
+	/// `std::expected<ParseEvent, ParseError>` for each event as it is
+	/// parsed. An error is yielded at the point it occurs and ends the
+	/// generator. Elements after the last item consumed are not parsed.
+	///
+	/// @note Only available if the standard library provides
+	/// `std::generator`. Ensure that the generator does not outlive the
+	/// elements in [first, last), or the parser.
+	template<detail::ArgumentIterator I>
+	auto parse_lazily(I first, I last) const -> std::generator<std::expected<ParseEvent, ParseError>> {
+		Cursor<I> cursor(self(), std::move(first), std::move(last));
+
+		while (auto event = cursor.next()) {
+			co_yield std::move(*event);
+		}
+	}
+#endif
+
+	/// @brief Get events for arguments in range [first, last).
+	///
+	/// Returns an input range of `std::expected<ParseEvent, ParseError>`,
+	/// with an event for each option occurence and positional argument,
+	/// in the order they appear. The elements are parsed lazily as the
+	/// range is iterated, and an error ends the range.
+	///
+	/// @note Ensure that the range does not outlive the elements in
+	/// [first, last), or the parser.
+	template<detail::ArgumentIterator I>
+	auto events(I first, I last) const -> ParseEventRange<Derived, I> {
+		return ParseEventRange<Derived, I>(self(), std::move(first), std::move(last));
+	}
+
+	/// @brief Write help text for options added to parser to `out`.
+	///
+	/// Like `get_option_help()`, but writes the help directly to `out`
+	/// without building a string first.
+	///
+	/// @param out output iterator
+	/// @param line_width width to word wrap lines at, or 0 to disable
+	/// @return output iterator past the last character written
+	template<std::output_iterator<char> O>
+	constexpr auto format_option_help_to(O out, std::size_t line_width = 0) const -> O {
+		return detail::write_option_help(self().options, line_width, std::move(out));
+	}
+
+	/// @brief Write help text for options added to parser to `f`.
+	///
+	/// The help is written through a fixed buffer on the stack.
+	///
+	/// @param f file to write to
+	/// @param line_width width to word wrap lines at, or 0 to disable
+	/// @return true on success, false if a write failed
+	auto format_option_help_to(std::FILE *f, std::size_t line_width = 0) const -> bool {
+		detail::FileWriter writer(f);
+
+		format_option_help_to(writer.begin(), line_width);
+
+		return writer.flush();
+	}
+
+protected:
+	/// @brief Check that argument of option event converts to bound
+	/// variable, if any, without storing it.
+	///
+	/// Parsers supporting bound variables hide this and `apply_binding()`.
+	///
+	/// @param arg_idx index of element containing the option argument
+	/// @return true if the option has a bound variable, false if not,
+	/// ParseError if conversion failed
+	auto check_binding(const ParseEvent &, std::size_t) const -> std::expected<bool, ParseError> {
+		return false;
+	}
+
+	/// @brief Store argument of option event in bound variable, after
+	/// `check_binding()` succeeded for the event.
+	auto apply_binding(const ParseEvent &) const -> void {}
+
+	/// @brief Store arguments of events for elements in [first, last)
+	/// before index `end` in bound variables, after parsing succeeded.
+	template<std::forward_iterator I>
+	auto apply_bindings(I first, I last, std::size_t end) const -> void {
+		if (end == 0) {
+			return;
+		}
+
+		Cursor<I> cursor(self(), std::move(first), std::move(last));
+
+		while (auto event = cursor.next()) {
+			if (!*event || (*event)->argv_index >= end) {
+				break;
+			}
+
+			self().apply_binding(**event);
+		}
+	}
+
+	/// @brief Add options from the environment to `res` after `parse_argv()`.
+	///
+	/// Parsers supporting environment variables hide this.
+	template<typename Result>
+	auto apply_environment(Result &) const -> std::expected<void, ParseError> {
+		return {};
+	}
+
+	/// @brief Keep `data` alive as long as the contents of `res`.
+	template<typename Result>
+	static auto add_storage(Result &res, std::shared_ptr<const void> data) -> void {
+		if (res.storage) {
+			using pair_type = std::pair<std::shared_ptr<const void>, std::shared_ptr<const void>>;
+
+			data = std::make_shared<const pair_type>(std::move(res.storage), std::move(data));
+		}
+
+		res.storage = std::move(data);
+	}
+
+	/// @brief Parse elements after a positional argument for a subcommand.
+	///
+	/// Parsers supporting subcommands hide this.
+	///
+	/// @param event positional argument event
+	/// @param first next element to parse
+	/// @param before_binding passed on to `parse_events_into()`
+	/// @return nothing if there is no subcommand, otherwise the result of
+	/// parsing [first, last) for the subcommand
+	template<bool bind, typename Result, std::forward_iterator I, typename BeforeBinding>
+	auto parse_subcommand(Result &, const ParseEvent &, I, I, const BeforeBinding &) const -> std::optional<std::expected<void, ParseError>> {
+		return {};
+	}
+
+	/// @brief Default `before_binding` of `parse_events_into()`, which does nothing.
+	struct NoBeforeBinding {
+		auto operator()() const -> std::expected<void, ParseError> {
+			return {};
+		}
+	};
+
+	/// @brief Parse range [first, last) into `res`, after clearing it.
+	///
+	/// If `bind` is true, `before_binding()` is called once parsing
+	/// succeeded, and bound variables are only set if it succeeds too.
+	/// After a subcommand, its parser calls it before setting its own.
+	///
+	/// @tparam bind true to set bound variables
+	template<bool bind, typename Result, std::forward_iterator I, typename BeforeBinding = NoBeforeBinding>
+	auto parse_events_into(Result &res, I first, I last, BeforeBinding before_binding = {}) const -> std::expected<void, ParseError> {
+		res.clear();
+
+		Cursor<I> cursor(self(), first, last);
+
+		// Bound variables are only set once parsing succeeded. The
+		// events for them are kept, or if there are too many, found by
+		// parsing the elements before bind_end again
+		std::array<ParseEvent, 16> bound_events;
+		std::size_t num_bound = 0;
+		std::size_t bind_end = 0;
+
+		auto set_bound_variables = [&] {
+			if (num_bound <= bound_events.size()) {
+				for (std::size_t i = 0; i < num_bound; ++i) {
+					self().apply_binding(bound_events[i]);
+				}
+			}
+			else {
+				apply_bindings(std::move(first), std::move(last), bind_end);
+			}
+		};
+
+		while (auto event = cursor.next()) {
+			if (!*event) {
+				return std::unexpected(std::move(event->error()));
+			}
+
+			// Elements after "--" are never subcommands
+			if ((*event)->kind == ParseEventKind::positional && !cursor.positional_only()) {
+				if (auto parsed = self().template parse_subcommand<bind>(res, **event, cursor.position(), last, before_binding)) {
+					if constexpr (bind) {
+						if (*parsed) {
+							set_bound_variables();
+						}
+					}
+
+					return std::move(*parsed);
+				}
+			}
+
+			if constexpr (bind) {
+				// The option argument, if any, is in the element
+				// before the next one to parse
+				auto bound = self().check_binding(**event, cursor.index() - 1);
+
+				if (!bound) {
+					return std::unexpected(std::move(bound.error()));
+				}
+
+				if (*bound) {
+					if (num_bound < bound_events.size()) {
+						bound_events[num_bound] = **event;
+					}
+
+					++num_bound;
+					bind_end = (*event)->argv_index + 1;
+				}
+			}
+
+			add_event_to_result(res, **event);
+
+			// Add the remaining positional arguments after "--" at once
+			if (cursor.positional_only()) {
+				auto remaining = cursor.take_remaining();
+
+				res.add_positional_arguments(remaining.begin(), remaining.end());
+
+				break;
+			}
+		}
+
+		if constexpr (bind) {
+			if (auto checked = before_binding(); !checked) {
+				return checked;
+			}
+
+			set_bound_variables();
+		}
+
+		return {};
+	}
+
+	template<typename Result>
+	static auto add_event_to_result(Result &res, const ParseEvent &event) -> void {
+		if (event.kind == ParseEventKind::positional) {
+			res.add_positional_argument(*event.argument);
+		}
+		else if (event.argument) {
+			res.add_parsed_option(event.option_id, event.name, *event.argument);
+		}
+		else {
+			res.add_parsed_option(event.option_id, event.name);
+		}
+	}
+
+private:
+	bool response_files = false;
+
+	constexpr auto self() const -> const Derived & {
+		return static_cast<const Derived &>(*this);
+	}
+
+	template<typename Result, std::forward_iterator I, typename BeforeBinding>
+	auto parse_before_binding(I first, I last, const typename Result::allocator_type &alloc,
+	                          const BeforeBinding &before_binding) const -> std::expected<Result, ParseError> {
+		Result res(alloc);
+
+		auto before_binding_res = [&] {
+			return before_binding(res);
+		};
+
+		if (auto parsed = parse_events_into<true>(res, std::move(first), std::move(last), before_binding_res); !parsed) {
+			return std::unexpected(std::move(parsed.error()));
+		}
+
+		return res;
+	}
+
+	template<typename Result, std::forward_iterator I, typename BeforeBinding>
+	auto parse_response_files(I first, I last, const typename Result::allocator_type &alloc,
+	                          const BeforeBinding &before_binding) const -> std::expected<Result, ParseError> {
+		auto expanded = ResponseFileArgs::expand(std::move(first), std::move(last));
+
+		if (!expanded) {
+			return std::unexpected(std::move(expanded.error()));
+		}
+
+		auto args = expanded->args();
+
+		// Errors from before_binding do not refer to an element
+		bool parsed = false;
+
+		auto result = parse_before_binding<Result>(args.begin(), args.end(), alloc, [&](Result &res) {
+			parsed = true;
+
+			return before_binding(res);
+		});
+
+		if (!result) {
+			if (!parsed) {
+				result.error().originating_arg = expanded->origin(result.error().originating_arg);
+			}
+		}
+		else if constexpr (std::same_as<typename Result::string_type, std::string_view>) {
+			result->storage = std::make_shared<const ResponseFileArgs>(std::move(*expanded));
+		}
+
+		return result;
+	}
+};
+
+} // namespace detail
+
+/// @brief Input range of the events from parsing a range of elements.
+///
+/// Returned by `events()` of an option parser.
+template<typename Parser, std::forward_iterator I>
+class ParseEventRange {
+	using cursor_type = typename detail::OptionParserBase<Parser>::template Cursor<I>;
+
+public:
+	using value_type = std::expected<ParseEvent, ParseError>;
+
+	class iterator {
+	public:
+		using value_type = ParseEventRange::value_type;
+		using difference_type = std::ptrdiff_t;
+
+		iterator() = default;
+
+		explicit iterator(ParseEventRange *range) : range(range) {}
+
+		auto operator*() const -> const value_type & {
+			return *range->current;
+		}
+
+		auto operator->() const -> const value_type * {
+			return &*range->current;
+		}
+
+		auto operator++() -> iterator & {
+			range->advance();
+
+			return *this;
+		}
+
+		auto operator++(int) -> void {
+			++*this;
+		}
+
+		auto operator==(std::default_sentinel_t) const -> bool {
+			return !range->current;
+		}
+
+	private:
+		ParseEventRange *range = nullptr;
+	};
+
+	ParseEventRange(const Parser &parser, I first, I last)
+		: cursor(parser, std::move(first), std::move(last)) {}
+
+	auto begin() -> iterator {
+		if (!started) {
+			started = true;
+			advance();
+		}
+
+		return iterator(this);
+	}
+
+	auto end() const -> std::default_sentinel_t {
+		return {};
+	}
+
+private:
+	cursor_type cursor;
+	std::optional<value_type> current;
+	bool started = false;
+
+	auto advance() -> void {
+		// An error ends the range
+		if (current && !*current) {
+			current.reset();
+
+			return;
+		}
+
+		current = cursor.next();
+	}
+};
+
+/// @brief Parser for command-line options.
+///
+/// `Allocator` is used for all memory allocated by the parser to store
+/// options, see `cpparg::pmr::OptionParser`.
+template<typename Allocator = std::allocator<char>>
+class BasicOptionParser : public detail::OptionParserBase<BasicOptionParser<Allocator>> {
+	friend detail::OptionParserBase<BasicOptionParser>;
+
+	template<typename T>
+	using rebind_alloc = typename std::allocator_traits<Allocator>::template rebind_alloc<T>;
+
+	using string_type = std::basic_string<char, std::char_traits<char>, rebind_alloc<char>>;
+
+	struct Option {
+		string_type short_flag;
+		string_type long_flag;
+		string_type arg_name;
+		string_type description;
+
+		// Bound variable and function converting arguments to it
+		void *target = nullptr;
+		auto (*convert)(void *, std::optional<std::string_view>) -> std::expected<void, std::errc> = nullptr;
+
+		auto takes_argument() const noexcept -> bool {
+			return !arg_name.empty();
+		}
+
+		auto requires_argument() const noexcept -> bool {
+			return takes_argument() && !arg_name.starts_with('[');
+		}
+	};
+
+	// Parser for a subcommand, created by factory when first used
+	struct Subcommand {
+		std::function<BasicOptionParser()> factory;
+		std::once_flag created;
+		std::unique_ptr<BasicOptionParser> parser;
+	};
+
+public:
+	using allocator_type = Allocator;
+
+	BasicOptionParser() = default;
+
+	explicit BasicOptionParser(const allocator_type &alloc)
+		: options(alloc), long_lookup(alloc), sorted_long(alloc), env_prefix(alloc), subcommands(alloc) {}
+
+	/// @brief Get allocator used by parser.
+	auto get_allocator() const -> allocator_type {
+		return allocator_type(options.get_allocator());
+	}
+
+	/// @brief Add option.
+	///
+	/// If `arg_name` is enclosed in square brackets, like "[ARG]", the
+	/// option argument is optional. Otherwise it is required.
+	///
+	/// By default, required arguments are printed as separate elements
+	/// in option help. You can change this by adding a '=' to `arg_name`.
+	///
+	///     "f" "foo" "ARG"  becomes -f, --foo ARG
+	///     "f" ""    "ARG"  becomes -f ARG
+	///     "f" "foo" "=ARG" becomes -f, --foo=ARG
+	///     "f" ""    "=ARG" becomes -fARG
+	///
 	/// @param short_flag string containing single character short flag
 	/// @param long_flag long flag
 	/// @param arg_name option argument name, optional if in square brackets
 	/// @param description option description
 	/// @return reference to this, so calls can be chained
-	auto add_option(std::string short_flag, std::string long_flag,
-	                std::string arg_name, std::string description) -> OptionParser& {
-		if (short_flag.size() > 1) {
-			short_flag.resize(1);
+	auto add_option(std::string_view short_flag, std::string_view long_flag,
+	                std::string_view arg_name, std::string_view description) -> BasicOptionParser& {
+		// Strings stored in the option use the allocator of the parser
+		rebind_alloc<char> alloc(options.get_allocator());
+
+		short_flag = short_flag.substr(0, 1);
+
+		// Adjust arg_name for use in option help
+		string_type help_arg_name(alloc);
+
+		detail::write_help_arg_name(arg_name, !long_flag.empty(), std::back_inserter(help_arg_name));
+
+		if (long_flag.empty()) {
+			long_flag = short_flag;
+		}
+
+		// If the long flag is already in use, the first option added
+		// with it takes precedence
+		bool inserted = long_lookup.try_emplace(string_type(long_flag, alloc), options.size()).second;
+
+		// Long flags are only kept sorted while prefixes are allowed
+		if (inserted && allow_long_prefixes) {
+			auto pos = std::ranges::upper_bound(sorted_long, long_flag, {},
+				[&](std::size_t idx) -> std::string_view { return options[idx].long_flag; }
+			);
+
+			sorted_long.insert(pos, options.size());
+		}
+
+		// Likewise for the short flag
+		if (!short_flag.empty()) {
+			auto &slot = short_lookup[static_cast<unsigned char>(short_flag.front())];
+
+			if (slot == 0) {
+				slot = options.size() + 1;
+			}
+		}
+
+		options.emplace_back(
+			string_type(short_flag, alloc), string_type(long_flag, alloc),
+			std::move(help_arg_name), string_type(description, alloc)
+		);
+
+		return *this;
+	}
+
+	/// @brief Bind variable to the most recently added option.
+	///
+	/// When parsing with `parse()`, `parse_into()` or `parse_argv()`, the
+	/// argument of each occurrence of the option is checked, and once
+	/// parsing succeeded converted directly into `var`, so the last
+	/// occurrence wins. If parsing fails, `var` is left unchanged. The
+	/// option is also added to the result as usual.
+	///
+	/// Integer and floating-point arguments are converted with
+	/// `convert_to()`, and types assignable from `std::string_view` are
+	/// assigned the argument. A `bool` is set to true by the option
+	/// without an argument, and converted with `convert_to()` if it has
+	/// one. Other types are left unchanged if there is no argument.
+	///
+	///     int threads = 1;
+	///     parser.add_option("j", "threads", "N", "number of threads").bind(threads);
+	///
+	/// If an argument cannot be converted, parsing fails with a
+	/// `ParseError` for the element containing the argument.
+	///
+	/// @note Ensure that `var` outlives the parser, and that it is not
+	/// accessed while parsing.
+	///
+	/// @param var variable to bind
+	/// @return reference to this, so calls can be chained
+	template<detail::Bindable T>
+	auto bind(T &var) -> BasicOptionParser& {
+		if (!options.empty()) {
+			options.back().target = &var;
+			options.back().convert = &detail::Binder<T>::convert;
+		}
+
+		return *this;
+	}
+
+	/// @brief Set prefix of environment variables for options.
+	///
+	/// If set, `parse_argv()` adds options that are not in `argv` from
+	/// environment variables named by the prefix, an underscore, and the
+	/// long flag in upper case with '-' replaced by '_'. So with prefix
+	/// "APP", "APP_DRY_RUN" is used for "--dry-run". See
+	/// `merge_environment()`.
+	///
+	/// @param prefix prefix of environment variables, empty to disable
+	/// @return reference to this, so calls can be chained
+	auto set_env_prefix(std::string_view prefix) -> BasicOptionParser& {
+		env_prefix.assign(prefix);
+
+		return *this;
+	}
+
+	/// @brief Add options that are not in `res` from the environment.
+	///
+	/// `envp` is a null-terminated array of "NAME=value" strings, like
+	/// `environ`. It is scanned once, and each variable with the prefix
+	/// set by `set_env_prefix()` is matched to an option by looking up
+	/// its long flag.
+	///
+	/// For an option taking an argument, the value is the argument. For
+	/// other options, the value is converted with `convert_to<bool>()`,
+	/// and the option added if it is true. Options already in `res` are
+	/// left unchanged, so `argv` takes precedence over the environment.
+	/// Bound variables are set like when parsing, only if all variables
+	/// are valid.
+	///
+	/// @note If `res` is a view, it refers to the strings in `envp`.
+	///
+	/// @param envp array of environment variables
+	/// @return nothing on success, ParseError with the index in `envp`
+	/// of the variable otherwise
+	template<typename Result>
+	auto merge_environment(Result &res, const char * const envp[]) const -> std::expected<void, ParseError> {
+		if (env_prefix.empty() || envp == nullptr) {
+			return {};
+		}
+
+		std::string long_flag;
+
+		// Events for bound variables, set once all variables are valid
+		std::vector<ParseEvent> bound_events;
+
+		for (std::size_t idx = 0; envp[idx] != nullptr; ++idx) {
+			std::string_view var(envp[idx]);
+
+			if (!var.starts_with(env_prefix) || !var.substr(env_prefix.size()).starts_with('_')) {
+				continue;
+			}
+
+			auto name_end = var.find('=', env_prefix.size() + 1);
+
+			if (name_end == std::string_view::npos) {
+				continue;
+			}
+
+			long_flag.clear();
+
+			for (char ch : var.substr(env_prefix.size() + 1, name_end - env_prefix.size() - 1)) {
+				long_flag.push_back(ch == '_' ? '-' : detail::to_lower(ch));
+			}
+
+			auto *option = find_long_option(long_flag);
+
+			if (option == nullptr || res.contains(id_of(option))) {
+				continue;
+			}
+
+			auto value = var.substr(name_end + 1);
+
+			ParseEvent event{ParseEventKind::option, id_of(option), option->long_flag, value, idx};
+
+			bool valid = true;
+
+			if (!option->takes_argument()) {
+				auto flag = convert_to<bool>(value);
+
+				if (flag && !*flag) {
+					continue;
+				}
+
+				valid = flag.has_value();
+
+				event.argument.reset();
+			}
+
+			auto bound = check_binding(event, idx);
+
+			if (!valid || !bound) {
+				return std::unexpected<ParseError>(std::in_place, idx,
+					std::format("invalid value '{}' for environment variable '{}'", value, var.substr(0, name_end))
+				);
+			}
+
+			if (*bound) {
+				bound_events.push_back(event);
+			}
+
+			this->add_event_to_result(res, event);
+		}
+
+		for (const auto &event : bound_events) {
+			apply_binding(event);
+		}
+
+		return {};
+	}
+
+	/// @brief Add options that are not in `res` from `environ`.
+	template<typename Result>
+	auto merge_environment(Result &res) const -> std::expected<void, ParseError> {
+		return merge_environment(res, detail::environment());
+	}
+
+	/// @brief Add options that are not in `res` from config file `path`.
+	///
+	/// The file is read like response files, see `merge_config()` for
+	/// the format. If `res` is a view, it keeps the contents alive.
+	///
+	/// @return nothing on success, ParseError with the line number
+	/// otherwise
+	template<typename Result>
+	auto merge_config_file(Result &res, const char *path) const -> std::expected<void, ParseError> {
+		auto file = std::make_shared<detail::MappedFile>();
+
+		std::string id;
+
+		if (!file->open(path, id)) {
+			return std::unexpected<ParseError>(std::in_place, 0,
+				std::format("unable to open config file '{}'", path)
+			);
+		}
+
+		auto merged = merge_config(res, std::string_view(file->data(), file->size()), path);
+
+		if constexpr (std::same_as<typename Result::string_type, std::string_view>) {
+			this->add_storage(res, std::move(file));
+		}
+
+		return merged;
+	}
+
+	/// @brief Add options that are not in `res` from config `text`.
+	///
+	/// Each line contains an option, as "name = value" like in INI
+	/// files, or as "--name=value" or "--name value" like in `argv`.
+	/// Leading and trailing whitespace is ignored, and a value in double
+	/// quotes has the quotes removed. Lines that are blank or start with
+	/// '#' or ';' are skipped. Section headers are not supported.
+	///
+	/// The name is the long flag of the option. For an option without an
+	/// argument, a value is converted with `convert_to<bool>()`, and the
+	/// option added if it is true. Options already in `res` are left
+	/// unchanged, so for instance `argv` can take precedence over the
+	/// config. Bound variables are set like when parsing, only if all
+	/// lines are valid.
+	///
+	/// The text is tokenized in place, so if `res` is a view it refers
+	/// to `text`.
+	///
+	/// @param source name used in error messages, like a file name
+	/// @return nothing on success, ParseError with the line number
+	/// otherwise
+	template<typename Result>
+	auto merge_config(Result &res, std::string_view text, std::string_view source = "config") const -> std::expected<void, ParseError> {
+		// Options given before the config, which it does not change
+		std::vector<bool> given(options.size());
+
+		for (std::size_t i = 0; i < options.size(); ++i) {
+			given[i] = res.contains(OptionId{i});
+		}
+
+		auto fail = [&](std::size_t line_num, std::string what) -> std::expected<void, ParseError> {
+			return std::unexpected<ParseError>(std::in_place, line_num,
+				std::format("{}:{}: {}", source, line_num, what)
+			);
+		};
+
+		// Events for bound variables, set once all lines are valid
+		std::vector<ParseEvent> bound_events;
+
+		for (std::size_t line_num = 1; !text.empty(); ++line_num) {
+			auto line_end = text.find('\n');
+
+			auto line = detail::split_config_line(text.substr(0, line_end));
+
+			text.remove_prefix(line_end == std::string_view::npos ? text.size() : line_end + 1);
+
+			if (line.kind == detail::ConfigLine::Kind::empty) {
+				continue;
+			}
+
+			if (line.kind == detail::ConfigLine::Kind::section) {
+				return fail(line_num, std::format("unsupported section header '{}'", line.name));
+			}
+
+			auto *option = find_long_option(line.name);
+
+			if (option == nullptr) {
+				return fail(line_num, std::format("unrecognized option '{}'", line.name));
+			}
+
+			auto id = id_of(option);
+
+			if (given[id.index]) {
+				continue;
+			}
+
+			ParseEvent event{ParseEventKind::option, id, option->long_flag, line.value, line_num};
+
+			if (!option->takes_argument()) {
+				if (line.value) {
+					auto flag = convert_to<bool>(*line.value);
+
+					if (!flag) {
+						return fail(line_num, std::format("invalid value '{}' for '{}'", *line.value, line.name));
+					}
+
+					if (!*flag) {
+						continue;
+					}
+
+					event.argument.reset();
+				}
+			}
+			else if (!line.value && option->requires_argument()) {
+				return fail(line_num, std::format("missing required argument for '{}'", line.name));
+			}
+
+			auto bound = check_binding(event, line_num);
+
+			if (!bound) {
+				return fail(line_num, std::format("invalid value '{}' for '{}'", *line.value, line.name));
+			}
+
+			if (*bound) {
+				bound_events.push_back(event);
+			}
+
+			this->add_event_to_result(res, event);
+		}
+
+		for (const auto &event : bound_events) {
+			apply_binding(event);
+		}
+
+		return {};
+	}
+
+	/// @brief Add option and get its id.
+	///
+	/// Works like `add_option`, but returns the `OptionId` of the added
+	/// option, which can be used to query a `ParseResult`.
+	///
+	/// @return id of the added option
+	auto add_option_with_id(std::string_view short_flag, std::string_view long_flag,
+	                        std::string_view arg_name, std::string_view description) -> OptionId {
+		add_option(short_flag, long_flag, arg_name, description);
+
+		return OptionId{options.size() - 1};
+	}
+
+	/// @brief Get id of option with long flag `long_flag`.
+	auto find_option_id(std::string_view long_flag) const -> std::optional<OptionId> {
+		if (auto *option = find_long_option(long_flag)) {
+			return id_of(option);
 		}
 
-		// Adjust arg_name for use in option help
-		if (arg_name.starts_with('=')) {
-			// Required argument starting with '='
-			if (long_flag.empty()) {
-				// No long flag, remove '=' so -f=ARG becomes -fARG
-				arg_name.erase(0, 1);
-			}
-		}
-		else if (arg_name.starts_with('[')) {
-			// Optional argument
-			if (long_flag.empty()) {
-				// No long flag, remove any '=' so -f[=ARG] becomes -f[ARG]
-				if (arg_name.starts_with("[=")) {
-					arg_name.erase(1, 1);
-				}
-			}
-			else {
-				// Long flag, add '=' so --foo[ARG] becomes --foo[=ARG]
-				if (!arg_name.starts_with("[=")) {
-					arg_name.insert(1, 1, '=');
-				}
-			}
+		return {};
+	}
+
+	/// @brief Add subcommand.
+	///
+	/// When parsing, the first positional argument must name a
+	/// subcommand, unless it follows "--", and the elements after it are
+	/// parsed by the parser returned by `factory` into the result for the
+	/// subcommand, see `BasicParseResult::get_subcommand_result()`.
+	/// `factory` is called the first time the subcommand is used, so only
+	/// parsers for the subcommands used are created. Copies of the parser
+	/// share the subcommand parsers.
+	///
+	///     parser.add_subcommand("commit", [] {
+	///         cpparg::OptionParser commit;
+	///         commit.add_option("m", "message", "MSG", "commit message");
+	///         return commit;
+	///     });
+	///
+	/// Subcommands are not used by `parse_with()` or `events()`.
+	///
+	/// @param name name of subcommand
+	/// @param factory function returning parser for subcommand
+	/// @return reference to this, so calls can be chained
+	template<std::invocable F>
+		requires std::convertible_to<std::invoke_result_t<F &>, BasicOptionParser>
+	auto add_subcommand(std::string_view name, F factory) -> BasicOptionParser& {
+		rebind_alloc<char> alloc(options.get_allocator());
+
+		// If the name is already in use, the first subcommand added
+		// with it takes precedence
+		if (auto [it, inserted] = subcommands.try_emplace(string_type(name, alloc)); inserted) {
+			it->second = std::allocate_shared<Subcommand>(rebind_alloc<Subcommand>(alloc));
+			it->second->factory = std::move(factory);
 		}
-		else if (!arg_name.empty()) {
-			// Required argument not starting with '=', insert space
-			// so -fARG becomes -f ARG and --fooARG becomes --foo ARG
-			arg_name.insert(0, 1, ' ');
+
+		return *this;
+	}
+
+	/// @brief Get parser for subcommand `name`, creating it if needed.
+	/// @return pointer to parser, nullptr if no subcommand `name`
+	auto get_subcommand_parser(std::string_view name) const -> const BasicOptionParser * {
+		if (auto it = subcommands.find(name); it != subcommands.end()) {
+			return &subcommand_parser(*it->second);
 		}
 
-		if (long_flag.empty()) {
-			long_flag = short_flag;
+		return nullptr;
+	}
+
+	/// @brief Allow unambiguous prefixes of long options.
+	///
+	/// If enabled, a long option that does not match any option exactly
+	/// is matched against the options it is a prefix of, like with
+	/// `getopt_long`. So "--verb" is taken as "--verbose", as long as no
+	/// other long option starts with "verb". Exact matches are always
+	/// preferred.
+	///
+	/// @param allow true to allow prefixes, false for only exact matches
+	/// @return reference to this, so calls can be chained
+	auto allow_long_option_prefixes(bool allow = true) -> BasicOptionParser& {
+		if (allow && !allow_long_prefixes) {
+			sorted_long.clear();
+
+			for (const auto &entry : long_lookup) {
+				sorted_long.push_back(entry.second);
+			}
+
+			std::ranges::sort(sorted_long, {}, [&](std::size_t idx) -> std::string_view {
+				return options[idx].long_flag;
+			});
 		}
 
-		options.emplace_back(
-			std::move(short_flag), std::move(long_flag),
-			std::move(arg_name), std::move(description)
-		);
+		allow_long_prefixes = allow;
 
 		return *this;
 	}
@@ -297,275 +2745,772 @@ public:
 	/// @param line_width width to word wrap lines at, or 0 to disable
 	/// @return string containing option help
 	auto get_option_help(std::size_t line_width = 0) const -> std::string {
-		// Help for each option consists of flags and description.
-		// This is a limit for how long the flags part can be.
-		// Options that exceed this will have their description
-		// start on the next line.
-		constexpr std::size_t flags_len_limit = 29;
+		std::string help;
+
+		this->format_option_help_to(std::back_inserter(help), line_width);
+
+		return help;
+	}
+
+private:
+	std::vector<Option, rebind_alloc<Option>> options;
+	std::unordered_map<string_type, std::size_t, detail::string_hash, std::equal_to<>,
+		rebind_alloc<std::pair<const string_type, std::size_t>>> long_lookup;
+
+	// Index plus one of option for each short flag character, 0 if none
+	std::array<std::size_t, 256> short_lookup{};
+
+	// Indices of options with distinct long flags, sorted by long flag,
+	// while long prefixes are allowed
+	std::vector<std::size_t, rebind_alloc<std::size_t>> sorted_long;
+
+	bool allow_long_prefixes = false;
+
+	string_type env_prefix;
+
+	std::unordered_map<string_type, std::shared_ptr<Subcommand>, detail::string_hash, std::equal_to<>,
+		rebind_alloc<std::pair<const string_type, std::shared_ptr<Subcommand>>>> subcommands;
+
+	static auto subcommand_parser(Subcommand &subcommand) -> const BasicOptionParser & {
+		std::call_once(subcommand.created, [&] {
+			subcommand.parser = std::make_unique<BasicOptionParser>(subcommand.factory());
+		});
+
+		return *subcommand.parser;
+	}
+
+	template<bool bind, typename Result, std::forward_iterator I, typename BeforeBinding>
+	auto parse_subcommand(Result &res, const ParseEvent &event, I first, I last, const BeforeBinding &before_binding) const -> std::optional<std::expected<void, ParseError>> {
+		if (subcommands.empty()) {
+			return {};
+		}
+
+		auto it = subcommands.find(*event.argument);
+
+		if (it == subcommands.end()) {
+			return std::expected<void, ParseError>(std::unexpect, event.argv_index,
+				std::format("unknown subcommand '{}'", *event.argument)
+			);
+		}
+
+		auto &parser = subcommand_parser(*it->second);
+
+		auto parsed = parser.template parse_events_into<bind>(res.set_subcommand(*event.argument), std::move(first), std::move(last), before_binding);
+
+		// Make index relative to the elements parsed by this
+		if (!parsed) {
+			parsed.error().originating_arg += event.argv_index + 1;
+		}
+
+		return parsed;
+	}
 
-		auto max_flags_length = [&] {
-			std::size_t longest_flags = 0;
+	auto find_long_option(std::string_view name) const -> const Option * {
+		if (auto it = long_lookup.find(name); it != long_lookup.end()) {
+			return &options[it->second];
+		}
+
+		return nullptr;
+	}
+
+	/// @brief Find option matching long option `name` in element `idx`.
+	///
+	/// If unambiguous prefixes are allowed and there is no exact match,
+	/// looks for an option that `name` is a prefix of.
+	///
+	/// @return pointer to option, nullptr if no match, ParseError if ambiguous
+	auto match_long_option(std::string_view name, std::size_t idx) const -> std::expected<const Option *, ParseError> {
+		auto *option = find_long_option(name);
 
-			for (const auto &option : options) {
-				// Length of "  -f, --" plus long name
-				std::size_t len = 8 + option.long_flag.size();
+		if (option == nullptr && allow_long_prefixes && !name.empty()) {
+			auto candidates = find_long_option_candidates(name);
 
-				len += option.arg_name.size();
+			if (candidates.size() == 1) {
+				option = &options[candidates.front()];
+			}
+			else if (candidates.size() > 1) {
+				std::string candidate_list;
 
-				// Two spaces before description
-				len += 2;
+				for (auto candidate : candidates) {
+					candidate_list.append(candidate_list.empty() ? "'--" : ", '--");
+					candidate_list.append(options[candidate].long_flag);
+					candidate_list.append("'");
+				}
 
-				longest_flags = std::max(longest_flags, len);
+				return std::unexpected<ParseError>(std::in_place, idx,
+					std::format("ambiguous long option '--{}' could match {}", name, candidate_list)
+				);
 			}
+		}
+
+		return option;
+	}
 
-			return longest_flags;
+	/// @brief Find indices of options with a long flag starting with `prefix`.
+	auto find_long_option_candidates(std::string_view prefix) const -> std::span<const std::size_t> {
+		auto proj = [&](std::size_t idx) -> std::string_view {
+			return options[idx].long_flag;
 		};
 
-		std::size_t flags_len = std::min(flags_len_limit, max_flags_length());
+		auto first = std::ranges::lower_bound(sorted_long, prefix, {}, proj);
+
+		auto last = std::ranges::find_if_not(first, sorted_long.end(), [&](std::size_t idx) {
+			return proj(idx).starts_with(prefix);
+		});
+
+		return {first, last};
+	}
+
+	auto id_of(const Option *option) const -> OptionId {
+		return OptionId{static_cast<std::size_t>(option - options.data())};
+	}
+
+	template<typename Result>
+	auto apply_environment(Result &res) const -> std::expected<void, ParseError> {
+		return merge_environment(res);
+	}
 
-		// Adjust line width to at least flags_len
-		if (line_width && line_width < flags_len) {
-			line_width = flags_len;
+	auto bound_option(const ParseEvent &event) const -> const Option * {
+		if (event.kind != ParseEventKind::option || options[event.option_id.index].convert == nullptr) {
+			return nullptr;
 		}
 
-		std::string help;
+		return &options[event.option_id.index];
+	}
 
-		for (const auto &option : options) {
-			// Omit options marked as hidden
-			if (option.description.starts_with("[hidden]")) {
-				continue;
+	auto check_binding(const ParseEvent &event, std::size_t arg_idx) const -> std::expected<bool, ParseError> {
+		auto *option = bound_option(event);
+
+		if (option == nullptr) {
+			return false;
+		}
+
+		if (auto converted = option->convert(nullptr, event.argument); !converted) {
+			auto what = converted.error() == std::errc::result_out_of_range
+			          ? std::format("argument '{}' out of range for option '{}'", *event.argument, event.name)
+			          : std::format("invalid argument '{}' for option '{}'", *event.argument, event.name);
+
+			return std::unexpected<ParseError>(std::in_place, arg_idx, std::move(what));
+		}
+
+		return true;
+	}
+
+	auto apply_binding(const ParseEvent &event) const -> void {
+		if (auto *option = bound_option(event)) {
+			// Checked by check_binding(), so conversion succeeds
+			static_cast<void>(option->convert(option->target, event.argument));
+		}
+	}
+
+	auto find_short_option(char flag) const -> const Option * {
+		if (auto slot = short_lookup[static_cast<unsigned char>(flag)]; slot != 0) {
+			return &options[slot - 1];
+		}
+
+		return nullptr;
+	}
+};
+
+using OptionParser = BasicOptionParser<>;
+
+namespace pmr {
+
+using ParsedOption = BasicParsedOption<std::pmr::string, std::pmr::polymorphic_allocator<>>;
+using ParsedOptionView = BasicParsedOption<std::string_view, std::pmr::polymorphic_allocator<>>;
+using ParseResult = BasicParseResult<std::pmr::string, std::pmr::polymorphic_allocator<>>;
+using ParseResultView = BasicParseResult<std::string_view, std::pmr::polymorphic_allocator<>>;
+using OptionParser = BasicOptionParser<std::pmr::polymorphic_allocator<>>;
+
+} // namespace pmr
+
+namespace detail {
+
+/// @brief String literal usable as template argument.
+template<std::size_t N>
+struct FixedString {
+	constexpr FixedString(const char (&str)[N]) {
+		std::copy_n(str, N, data);
+	}
+
+	constexpr auto size() const -> std::size_t {
+		return N - 1;
+	}
+
+	constexpr auto view() const -> std::string_view {
+		return {data, N - 1};
+	}
+
+	char data[N] = {};
+};
+
+/// @brief Adjusted option argument name stored at compile time.
+template<std::size_t N>
+struct HelpArgName {
+	std::array<char, N> data{};
+	std::size_t size = 0;
+};
+
+constexpr auto fnv1a_hash(std::string_view sv) -> std::uint64_t {
+	std::uint64_t hash = 0xCBF29CE484222325ULL;
+
+	for (char ch : sv) {
+		hash ^= static_cast<unsigned char>(ch);
+		hash *= 0x100000001B3ULL;
+	}
+
+	return hash;
+}
+
+// Finalizer from splitmix64, used to derive slots from a hash and seed
+constexpr auto mix_hash(std::uint64_t hash, std::uint64_t seed) -> std::uint64_t {
+	hash += seed * 0x9E3779B97F4A7C15ULL;
+	hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+	return hash ^ (hash >> 31);
+}
+
+// These are not constexpr, so calling them while building a static
+// option schema results in a compile error naming the problem
+inline auto static_option_has_no_flag() -> void {}
+inline auto static_option_duplicate_short_flag() -> void {}
+inline auto static_option_duplicate_long_flag() -> void {}
+inline auto static_option_perfect_hash_failed() -> void {}
+
+} // namespace detail
+
+/// @brief Option of a `StaticOptionParser`.
+struct StaticOption {
+	std::string_view short_flag;
+	std::string_view long_flag;
+	std::string_view arg_name;
+	std::string_view description;
+
+	constexpr auto takes_argument() const noexcept -> bool {
+		return !arg_name.empty();
+	}
+
+	constexpr auto requires_argument() const noexcept -> bool {
+		return takes_argument() && !arg_name.starts_with('[');
+	}
+};
+
+/// @brief Option definition for `make_parser`.
+///
+/// The template arguments are the same as the arguments of
+/// `BasicOptionParser::add_option`.
+template<detail::FixedString ShortFlag, detail::FixedString LongFlag,
+         detail::FixedString ArgName = "", detail::FixedString Description = "">
+struct opt {
+	static_assert(ShortFlag.size() <= 1, "short flag must be at most one character");
+
+	static constexpr auto help_arg_name = [] {
+		detail::HelpArgName<ArgName.size() + 1> res;
+
+		auto last = detail::write_help_arg_name(ArgName.view(), LongFlag.size() != 0, res.data.begin());
+
+		res.size = static_cast<std::size_t>(last - res.data.begin());
+
+		return res;
+	}();
+
+	static constexpr StaticOption option = {
+		ShortFlag.view(),
+		LongFlag.size() != 0 ? LongFlag.view() : ShortFlag.view(),
+		std::string_view(help_arg_name.data.data(), help_arg_name.size),
+		Description.view()
+	};
+};
+
+/// @brief Option parser built entirely at compile time.
+///
+/// Create one with `make_parser`. All lookup tables are computed at
+/// compile time, so a `constexpr` parser has no startup cost, and parsing
+/// only reads static data. Long options are found through a perfect hash,
+/// short options through a table indexed by the flag character.
+///
+/// Unlike `OptionParser`, only exact matches for long options are
+/// supported.
+template<std::size_t N>
+class StaticOptionParser : public detail::OptionParserBase<StaticOptionParser<N>> {
+	friend detail::OptionParserBase<StaticOptionParser>;
+
+	static_assert(N < std::numeric_limits<std::uint16_t>::max(), "too many options");
+
+	static constexpr std::size_t bucket_count = std::bit_ceil(std::max<std::size_t>(N, 1));
+	static constexpr std::size_t slot_count = 2 * bucket_count;
+
+public:
+	consteval explicit StaticOptionParser(const std::array<StaticOption, N> &option_list) : options(option_list) {
+		for (std::size_t idx = 0; idx < N; ++idx) {
+			const auto &option = options[idx];
+
+			if (option.long_flag.empty()) {
+				detail::static_option_has_no_flag();
 			}
 
-			// Add short flag or space
-			std::string option_line = option.short_flag.empty() ? "    " : std::format("  -{}", option.short_flag);
+			if (!option.short_flag.empty()) {
+				auto &slot = short_lookup[static_cast<unsigned char>(option.short_flag.front())];
 
-			// Add long flag if present
-			if (!option.long_flag.empty() && option.long_flag != option.short_flag) {
-				if (!option.short_flag.empty()) {
-					option_line.append(", ");
-				}
-				else {
-					option_line.append("  ");
+				if (slot != 0) {
+					detail::static_option_duplicate_short_flag();
 				}
 
-				option_line.append(std::format("--{}", option.long_flag));
+				slot = static_cast<std::uint16_t>(idx + 1);
 			}
+		}
+
+		build_long_lookup();
+	}
+
+	/// @brief Access options.
+	constexpr auto get_options() const -> const std::array<StaticOption, N>& {
+		return options;
+	}
+
+	/// @brief Generate help text for options.
+	///
+	/// To render the help at compile time, use `static_option_help`.
+	///
+	/// @param line_width width to word wrap lines at, or 0 to disable
+	/// @return string containing option help
+	constexpr auto get_option_help(std::size_t line_width = 0) const -> std::string {
+		std::string help;
+
+		this->format_option_help_to(std::back_inserter(help), line_width);
+
+		return help;
+	}
 
-			// Add option argument
-			option_line.append(option.arg_name);
+	/// @brief Get id of option with long flag `long_flag`.
+	constexpr auto find_option_id(std::string_view long_flag) const -> std::optional<OptionId> {
+		if (auto *option = find_long_option(long_flag)) {
+			return id_of(option);
+		}
+
+		return {};
+	}
 
-			// The flags part of the option is done now. We need
-			// to format the description, starting with any
-			// leading space to align all the descriptions, or
-			// possibly a newline if the flags part was too long.
+	/// @brief Get id of option with long flag `long_flag`.
+	///
+	/// It is a compile error if there is no such option.
+	consteval auto get_option_id(std::string_view long_flag) const -> OptionId {
+		return find_option_id(long_flag).value();
+	}
 
-			if (option.description.empty()) {
-				option_line.append("\n");
+private:
+	std::array<StaticOption, N> options;
 
-				help.append(option_line);
+	// Index plus one of option for each short flag character, 0 if none
+	std::array<std::uint16_t, 256> short_lookup{};
 
-				continue;
+	// Perfect hash of long flags. The hash of a long flag selects a
+	// bucket, and the seed of the bucket then selects a slot containing
+	// the index plus one of the option.
+	std::array<std::uint16_t, bucket_count> bucket_seeds{};
+	std::array<std::uint16_t, slot_count> slots{};
+
+	static constexpr auto bucket_of(std::uint64_t hash) -> std::size_t {
+		return hash & (bucket_count - 1);
+	}
+
+	static constexpr auto slot_of(std::uint64_t hash, std::uint64_t seed) -> std::size_t {
+		return detail::mix_hash(hash, seed) & (slot_count - 1);
+	}
+
+	consteval auto build_long_lookup() -> void {
+		std::array<std::uint64_t, N> hashes{};
+
+		// Sort option indices by bucket
+		std::array<std::size_t, bucket_count + 1> bucket_start{};
+		std::array<std::size_t, N> by_bucket{};
+
+		for (std::size_t idx = 0; idx < N; ++idx) {
+			hashes[idx] = detail::fnv1a_hash(options[idx].long_flag);
+			bucket_start[bucket_of(hashes[idx]) + 1]++;
+		}
+
+		for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+			bucket_start[bucket + 1] += bucket_start[bucket];
+		}
+
+		{
+			auto next = bucket_start;
+
+			for (std::size_t idx = 0; idx < N; ++idx) {
+				by_bucket[next[bucket_of(hashes[idx])]++] = idx;
 			}
+		}
+
+		// Place largest buckets first, while most slots are free
+		std::array<std::size_t, bucket_count> bucket_order{};
+
+		for (std::size_t bucket = 0; bucket < bucket_count; ++bucket) {
+			bucket_order[bucket] = bucket;
+		}
 
-			// Find leading space before description for first line
-			std::size_t leading_space = flags_len;
+		std::ranges::sort(bucket_order, [&](std::size_t lhs, std::size_t rhs) {
+			auto lhs_size = bucket_start[lhs + 1] - bucket_start[lhs];
+			auto rhs_size = bucket_start[rhs + 1] - bucket_start[rhs];
 
-			if (option_line.size() + 2 > flags_len) {
-				option_line.append("\n");
+			return lhs_size != rhs_size ? lhs_size > rhs_size : lhs < rhs;
+		});
+
+		for (auto bucket : bucket_order) {
+			auto first = bucket_start[bucket];
+			auto last = bucket_start[bucket + 1];
+
+			if (first == last) {
+				break;
 			}
-			else {
-				leading_space = flags_len - option_line.size();
+
+			// Equal long flags can never be placed
+			for (auto i = first; i < last; ++i) {
+				for (auto j = i + 1; j < last; ++j) {
+					if (options[by_bucket[i]].long_flag == options[by_bucket[j]].long_flag) {
+						detail::static_option_duplicate_long_flag();
+					}
+				}
 			}
 
-			// Add description
-			if (line_width) {
-				auto wrapped_description = detail::word_wrap(option.description, line_width - flags_len);
+			for (std::uint64_t seed = 0; ; ++seed) {
+				if (seed > std::numeric_limits<std::uint16_t>::max()) {
+					detail::static_option_perfect_hash_failed();
+				}
+
+				auto fits = [&] {
+					for (auto i = first; i < last; ++i) {
+						auto slot = slot_of(hashes[by_bucket[i]], seed);
+
+						if (slots[slot] != 0) {
+							return false;
+						}
+
+						for (auto j = first; j < i; ++j) {
+							if (slot_of(hashes[by_bucket[j]], seed) == slot) {
+								return false;
+							}
+						}
+					}
+
+					return true;
+				};
 
-				for (auto line : wrapped_description) {
-					option_line.append(leading_space, ' ');
+				if (fits()) {
+					for (auto i = first; i < last; ++i) {
+						slots[slot_of(hashes[by_bucket[i]], seed)] = static_cast<std::uint16_t>(by_bucket[i] + 1);
+					}
 
-					option_line.append(line);
-					option_line.append("\n");
+					bucket_seeds[bucket] = static_cast<std::uint16_t>(seed);
 
-					leading_space = flags_len;
+					break;
 				}
 			}
-			else {
-				option_line.append(leading_space, ' ');
-				option_line.append(option.description);
-				option_line.append("\n");
-			}
+		}
+	}
 
-			help.append(option_line);
+	constexpr auto find_long_option(std::string_view name) const -> const StaticOption * {
+		auto hash = detail::fnv1a_hash(name);
+
+		auto idx = slots[slot_of(hash, bucket_seeds[bucket_of(hash)])];
+
+		if (idx != 0 && options[idx - 1].long_flag == name) {
+			return &options[idx - 1];
 		}
 
-		return help;
+		return nullptr;
 	}
 
-	/// @brief Parse arguments in range [first, last).
-	/// @return ParseResult on success, ParseError otherwise
-	template<std::forward_iterator I>
-		requires std::convertible_to<std::iter_reference_t<I>, std::string_view>
-	auto parse(I first, I last) const -> std::expected<ParseResult, ParseError> {
-		ParseResult res;
+	auto match_long_option(std::string_view name, std::size_t) const -> std::expected<const StaticOption *, ParseError> {
+		return find_long_option(name);
+	}
 
-		for (std::size_t idx = 0; first != last; ++first, ++idx) {
-			std::string_view arg(*first);
+	constexpr auto find_short_option(char flag) const -> const StaticOption * {
+		if (auto slot = short_lookup[static_cast<unsigned char>(flag)]; slot != 0) {
+			return &options[slot - 1];
+		}
 
-			// Check for nonoption element (including '-')
-			if (!arg.starts_with('-') || arg == "-") {
-				res.add_positional_argument(arg);
+		return nullptr;
+	}
 
-				continue;
-			}
+	constexpr auto id_of(const StaticOption *option) const -> OptionId {
+		return OptionId{static_cast<std::size_t>(option - options.data())};
+	}
+};
 
-			// Check for long option
-			if (arg.starts_with("--")) {
-				if (arg == "--") {
-					res.add_positional_arguments(++first, last);
+namespace detail {
 
-					return res;
-				}
+template<const auto &Parser, std::size_t LineWidth>
+inline constexpr auto static_option_help_storage = [] {
+	std::array<char, Parser.get_option_help(LineWidth).size()> res{};
+
+	std::ranges::copy(Parser.get_option_help(LineWidth), res.begin());
+
+	return res;
+}();
+
+} // namespace detail
+
+/// @brief Help text for the options of `Parser`, rendered at compile time.
+///
+/// `Parser` must be a `StaticOptionParser` with static storage duration,
+/// for instance a `constexpr` variable at namespace scope. The text is
+/// stored in static read-only data, so printing it is a single write.
+///
+///     constexpr auto parser = cpparg::make_parser(...);
+///
+///     constexpr std::string_view help = cpparg::static_option_help<parser, 78>;
+///
+template<const auto &Parser, std::size_t LineWidth = 0>
+inline constexpr std::string_view static_option_help(
+	detail::static_option_help_storage<Parser, LineWidth>.data(),
+	detail::static_option_help_storage<Parser, LineWidth>.size()
+);
+
+/// @brief Create a `StaticOptionParser` from option definitions.
+///
+/// For example
+///
+///     constexpr auto parser = cpparg::make_parser(
+///         cpparg::opt<"h", "help", "", "print this help and exit">(),
+///         cpparg::opt<"o", "output", "FILE", "write output to FILE">()
+///     );
+///
+/// Options without a flag, and duplicate short or long flags, are
+/// compile errors.
+template<typename... Opts>
+consteval auto make_parser(Opts...) -> StaticOptionParser<sizeof...(Opts)> {
+	return StaticOptionParser<sizeof...(Opts)>({Opts::option...});
+}
+
+namespace detail {
+
+// Bit 7 of each byte is set if the character is not a decimal digit.
+//
+// Carries only propagate out of bytes that are not digits, so the result
+// is exact up to and including the first byte that is not a digit.
+constexpr auto swar_non_decimal_digits(std::uint64_t x) -> std::uint64_t {
+	constexpr std::uint64_t high_nibbles = 0xF0F0F0F0F0F0F0F0ULL;
+	constexpr std::uint64_t zeros = 0x3030303030303030ULL;
+
+	return swar_nonzero_bytes(((x & high_nibbles) ^ zeros) | (((x + 0x0606060606060606ULL) & high_nibbles) ^ zeros));
+}
+
+// Bit 7 of each byte is set if the character is not a hexadecimal digit,
+// exact up to and including the first byte that is not a digit
+constexpr auto swar_non_hex_digits(std::uint64_t x) -> std::uint64_t {
+	// Letters a-f or A-F have high nibble 6 (or 4) and low nibble 1-6
+	std::uint64_t lower = x | 0x2020202020202020ULL;
+	std::uint64_t low_nibbles = lower & 0x0F0F0F0F0F0F0F0FULL;
+
+	std::uint64_t not_letter = ((lower & 0xF0F0F0F0F0F0F0F0ULL) ^ 0x6060606060606060ULL)
+	                         | ((low_nibbles + 0x0909090909090909ULL) & 0xF0F0F0F0F0F0F0F0ULL)
+	                         | (((low_nibbles + 0x0F0F0F0F0F0F0F0FULL) & 0x1010101010101010ULL) ^ 0x1010101010101010ULL);
+
+	return swar_non_decimal_digits(x) & swar_nonzero_bytes(not_letter);
+}
+
+// Value of 8 decimal digits in little-endian order
+constexpr auto swar_decimal_value(std::uint64_t x) -> std::uint64_t {
+	x -= 0x3030303030303030ULL;
 
-				arg.remove_prefix(2);
+	// Combine pairs, then quads, then the two halves
+	x = (x * 10) + (x >> 8);
+	x = (((x & 0x000000FF000000FFULL) * (100 + (1000000ULL << 32)))
+	   + (((x >> 16) & 0x000000FF000000FFULL) * (1 + (10000ULL << 32)))) >> 32;
+
+	return x & 0xFFFFFFFFULL;
+}
 
-				auto name_end = arg.find('=');
+// Value of 8 hexadecimal digits in little-endian order
+constexpr auto swar_hex_value(std::uint64_t x) -> std::uint64_t {
+	// Digits have bit 6 clear, letters have bit 6 set and low nibble 1-6
+	x = (x & 0x0F0F0F0F0F0F0F0FULL) + ((x >> 6) & 0x0101010101010101ULL) * 9;
 
-				auto name = arg.substr(0, name_end);
+	// Combine pairs, then quads, then the two halves
+	x = ((x << 4) | (x >> 8)) & 0x00FF00FF00FF00FFULL;
+	x = ((x << 8) | (x >> 16)) & 0x0000FFFF0000FFFFULL;
+	x = ((x << 16) | (x >> 32)) & 0x00000000FFFFFFFFULL;
 
-				auto it = find_long_option(name);
+	return x;
+}
 
-				if (it == options.end()) {
-					return std::unexpected<ParseError>(std::in_place, idx,
-						std::format("unrecognized long option '--{}'", name)
-					);
-				}
+// Value of each character as a digit, 255 if not a digit
+inline constexpr auto digit_values = [] {
+	std::array<unsigned char, 256> values{};
 
-				// Handle option argument included in element (--foo=argument)
-				if (name_end != std::string_view::npos) {
-					auto argument = arg.substr(name_end + 1);
+	values.fill(255);
 
-					if (!it->takes_argument()) {
-						return std::unexpected<ParseError>(std::in_place, idx,
-							std::format("extraneous argument in '--{}'", arg)
-						);
-					}
+	for (unsigned char i = 0; i < 10; ++i) {
+		values['0' + i] = i;
+	}
 
-					res.add_parsed_option(name, argument);
+	for (unsigned char i = 0; i < 26; ++i) {
+		values['a' + i] = 10 + i;
+		values['A' + i] = 10 + i;
+	}
 
-					continue;
-				}
+	return values;
+}();
 
-				// No option argument in element, so if
-				// required take next element
-				if (it->requires_argument()) {
-					if (++first == last) {
-						return std::unexpected<ParseError>(std::in_place, idx,
-							std::format("missing required argument for '--{}'", arg)
-						);
-					}
+/// @brief Convert digits in [first, last) in base 10 or 16 to `value`,
+/// eight characters at a time.
+///
+/// Same semantics as `std::from_chars` for unsigned types, so on overflow
+/// `ptr` points past all the digits.
+///
+/// @note Requires a little-endian target and `UT` of at most 64 bits.
+template<std::unsigned_integral UT, unsigned int Base>
+auto from_chars_swar(const char *first, const char *last, UT &value) -> std::from_chars_result {
+	static_assert(Base == 10 || Base == 16);
+	static_assert(std::endian::native == std::endian::little && sizeof(UT) <= 8);
 
-					res.add_parsed_option(name, *first);
+	constexpr std::uint64_t zeros = 0x3030303030303030ULL;
 
-					++idx;
+	constexpr std::array<std::uint64_t, 9> powers_of_10 = {
+		1, 10, 100, 1'000, 10'000, 100'000, 1'000'000, 10'000'000, 100'000'000
+	};
 
-					continue;
-				}
+	// Number of digits that always fit in 64 bits
+	constexpr int safe_digits = Base == 10 ? 19 : 16;
 
-				// No option argument in element, none required
-				res.add_parsed_option(name);
+	auto digit_value = [](char c) -> unsigned int {
+		if constexpr (Base == 10) {
+			return static_cast<unsigned char>(c) - static_cast<unsigned int>('0');
+		}
+		else {
+			return digit_values[static_cast<unsigned char>(c)];
+		}
+	};
 
-				continue;
-			}
+	const char *p = first;
 
-			// Short option
-			arg.remove_prefix(1);
+	std::uint64_t res = 0;
 
-			for (std::size_t pos = 0; pos < arg.size(); ++pos) {
-				auto flag = arg.substr(pos, 1);
+	// Fewer than eight characters always fit in 64 bits
+	if (last - first < 8) {
+		for (unsigned int digit; p != last && (digit = digit_value(*p)) < Base; ++p) {
+			res = res * Base + digit;
+		}
 
-				auto it = find_short_option(flag);
+		if (p == first) {
+			return {first, std::errc::invalid_argument};
+		}
 
-				if (it == options.end()) {
-					return std::unexpected<ParseError>(std::in_place, idx,
-						std::format("unrecognized short option '{}' in '-{}'", flag, arg)
-					);
-				}
+		if (res > std::numeric_limits<UT>::max()) {
+			return {p, std::errc::result_out_of_range};
+		}
 
-				if (!it->takes_argument()) {
-					res.add_parsed_option(it->long_flag);
+		value = static_cast<UT>(res);
 
-					continue;
-				}
+		return {p, std::errc()};
+	}
 
-				// If more characters, take as option argument
-				if (pos + 1 < arg.size()) {
-					auto argument = arg.substr(pos + 1);
+	// Skip leading zeros
+	while (p != last && *p == '0') {
+		++p;
+	}
 
-					res.add_parsed_option(it->long_flag, argument);
+	int digits = 0;
 
-					break;
-				}
+	// Eight characters at a time while digits fit. A chunk with fewer
+	// than eight digits is padded with leading zeros.
+	while (p != last) {
+		std::uint64_t x;
 
-				if (!it->requires_argument()) {
-					res.add_parsed_option(it->long_flag);
+		if (auto remaining = last - p; remaining >= 8) {
+			std::memcpy(&x, p, sizeof(x));
+		}
+		else {
+			// Load last eight characters and shift out those already
+			// converted, leaving zero bytes after the end
+			std::memcpy(&x, last - 8, sizeof(x));
+			x >>= 8 * (8 - remaining);
+		}
 
-					break;
-				}
+		auto mask = Base == 10 ? swar_non_decimal_digits(x) : swar_non_hex_digits(x);
 
-				// Option argument required, so take next element
-				if (++first == last) {
-					return std::unexpected<ParseError>(std::in_place, idx,
-						std::format("missing required argument for '{}' in '-{}'", flag, arg)
-					);
-				}
+		int num_digits = mask != 0 ? std::countr_zero(mask) / 8 : 8;
 
-				res.add_parsed_option(it->long_flag, *first);
+		if (num_digits == 0 || digits + num_digits > safe_digits) {
+			break;
+		}
 
-				++idx;
+		if (num_digits < 8) {
+			x = (x << (8 * (8 - num_digits))) | (zeros >> (8 * num_digits));
+		}
 
-				break;
-			}
+		if constexpr (Base == 10) {
+			res = res * powers_of_10[num_digits] + swar_decimal_value(x);
+		}
+		else {
+			res = (res << (4 * num_digits)) | swar_hex_value(x);
 		}
 
-		return res;
-	}
+		digits += num_digits;
+		p += num_digits;
 
-	/// @brief Parse arguments in `argv`.
-	/// @return ParseResult on success, ParseError otherwise
-	auto parse_argv(int argc, const char * const argv[]) const -> std::expected<ParseResult, ParseError> {
-		if (argc < 1) {
-			return std::unexpected<ParseError>(std::in_place, 0,
-				"argc less than 1"
-			);
+		if (num_digits < 8) {
+			break;
 		}
+	}
 
-		auto result = parse(argv + 1, argv + argc);
+	// Remaining digits one at a time, checking for overflow when the
+	// result no longer surely fits
+	bool overflow = false;
 
-		if (!result) {
-			result.error().originating_arg++;
+	for (; p != last; ++p) {
+		unsigned int digit = digit_value(*p);
+
+		if (digit >= Base) {
+			break;
 		}
 
-		return result;
+		if (digits < safe_digits) {
+			res = res * Base + digit;
+			++digits;
+		}
+		else if (overflow || res > (std::numeric_limits<std::uint64_t>::max() - digit) / Base) {
+			overflow = true;
+		}
+		else {
+			res = res * Base + digit;
+		}
 	}
 
-private:
-	std::vector<Option> options;
-
-	using option_iterator = decltype(options)::const_iterator;
+	if (p == first) {
+		return {first, std::errc::invalid_argument};
+	}
 
-	auto find_long_option(std::string_view name) const -> option_iterator {
-		return std::ranges::find_if(options, [&](const auto &option) {
-			return option.long_flag == name;
-		});
+	if (overflow || res > std::numeric_limits<UT>::max()) {
+		return {p, std::errc::result_out_of_range};
 	}
 
-	auto find_short_option(std::string_view flag) const -> option_iterator {
-		return std::ranges::find_if(options, [&](const auto &option) {
-			return option.short_flag == flag;
-		});
+	value = static_cast<UT>(res);
+
+	return {p, std::errc()};
+}
+
+/// @brief `std::from_chars` for unsigned types, using `from_chars_swar`
+/// for base 10 and 16 where possible.
+template<std::unsigned_integral UT>
+constexpr auto from_chars_unsigned(const char *first, const char *last, UT &value, int base) -> std::from_chars_result {
+	if !consteval {
+		if constexpr (std::endian::native == std::endian::little && sizeof(UT) <= 8) {
+			if (base == 10) {
+				return from_chars_swar<UT, 10>(first, last, value);
+			}
+
+			if (base == 16) {
+				return from_chars_swar<UT, 16>(first, last, value);
+			}
+		}
 	}
-};
+
+	return std::from_chars(first, last, value, base);
+}
+
+} // namespace detail
 
 /// @brief Multiplication factor for Kilo unit prefix.
 enum struct KiloMultiplier : unsigned int {
@@ -630,7 +3575,7 @@ constexpr auto convert_to(std::string_view sv, int base = 10) -> std::expected<T
 
 	UT res{};
 
-	auto [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), res, base);
+	auto [ptr, ec] = detail::from_chars_unsigned(sv.data(), sv.data() + sv.size(), res, base);
 
 	if (ec != std::errc()) {
 		return std::unexpected(ec);
@@ -701,6 +3646,91 @@ static_assert(convert_to<unsigned int>("-1") == std::numeric_limits<unsigned int
 static_assert(convert_to<int, KiloMultiplier::decimal>("4K") == 4000);
 static_assert(convert_to<int, KiloMultiplier::binary>("4K") == 4096);
 
+/// @brief Convert a string to floating-point type `T`.
+///
+/// Uses `std::from_chars` with `std::chars_format::general`, so the
+/// conversion does not depend on the locale. Minus is recognized, plus and
+/// whitespace are not.
+///
+/// If `kilo` is `KiloMultiplier::none`, suffixes K, M, G, etc. are not
+/// supported. Otherwise `kilo` is used as multiplier for them, so "1.5K"
+/// is 1500 or 1536. A "%" suffix is always supported and divides the value
+/// by 100, so "12.5%" is 0.125.
+///
+/// Returns `std::errc::result_out_of_range` if the value, or the value
+/// multiplied by a suffix, is not finite in `T` (unless the string was
+/// "inf" or similar).
+///
+template<std::floating_point T, KiloMultiplier kilo = KiloMultiplier::none>
+auto convert_to(std::string_view sv) -> std::expected<T, std::errc> {
+	T res{};
+
+	auto [ptr, ec] = std::from_chars(sv.data(), sv.data() + sv.size(), res, std::chars_format::general);
+
+	if (ec != std::errc()) {
+		return std::unexpected(ec);
+	}
+
+	sv.remove_prefix(ptr - sv.data());
+
+	if (sv.empty()) {
+		return res;
+	}
+
+	if (sv.size() != 1) {
+		return std::unexpected(std::errc::invalid_argument);
+	}
+
+	if (sv.front() == '%') {
+		return res / 100;
+	}
+
+	if constexpr (kilo == KiloMultiplier::none) {
+		return std::unexpected(std::errc::invalid_argument);
+	}
+	else {
+		int power = 0;
+
+		switch (detail::to_upper(sv.front())) {
+		case 'K':
+			power = 1;
+			break;
+		case 'M':
+			power = 2;
+			break;
+		case 'G':
+			power = 3;
+			break;
+		case 'T':
+			power = 4;
+			break;
+		case 'P':
+			power = 5;
+			break;
+		case 'E':
+			power = 6;
+			break;
+		default:
+			return std::unexpected(std::errc::invalid_argument);
+			break;
+		}
+
+		T multiplier = 1;
+
+		while (power--) {
+			multiplier *= static_cast<T>(std::to_underlying(kilo));
+		}
+
+		T scaled = res * multiplier;
+
+		if (std::isfinite(res) && !std::isfinite(scaled)) {
+			return std::unexpected(std::errc::result_out_of_range);
+		}
+
+		return scaled;
+	}
+}
+
 /// @brief Convert a string to `bool`.
 ///
 /// Accepts "yes", "true", "on" and "1" as true,
@@ -727,6 +3757,360 @@ constexpr auto convert_to(std::string_view sv) -> std::expected<T, std::errc> {
 static_assert(convert_to<bool>("true") == true);
 static_assert(convert_to<bool>("false") == false);
 
+namespace detail {
+
+template<Bindable T>
+struct Binder {
+	// Convert `argument` and store it in `target`, or only check that it
+	// converts if `target` is null
+	static auto convert(void *target, std::optional<std::string_view> argument) -> std::expected<void, std::errc> {
+		auto *var = static_cast<T *>(target);
+
+		if constexpr (std::same_as<T, bool>) {
+			if (!argument) {
+				if (var != nullptr) {
+					*var = true;
+				}
+
+				return {};
+			}
+		}
+
+		if (!argument) {
+			return {};
+		}
+
+		if constexpr (std::integral<T> || std::floating_point<T>) {
+			auto value = convert_to<T>(*argument);
+
+			if (!value) {
+				return std::unexpected(value.error());
+			}
+
+			if (var != nullptr) {
+				*var = *value;
+			}
+		}
+		else if (var != nullptr) {
+			*var = *argument;
+		}
+
+		return {};
+	}
+};
+
+} // namespace detail
+
+/// @brief Error from `convert_list()`.
+struct ConvertListError {
+	std::size_t index = 0;
+	std::errc error{};
+};
+
+/// @brief Convert a list of values separated by `delimiter` to type `T`,
+/// writing them to `out`.
+///
+/// Each element is converted with `convert_to<T>` (using `kilo` for
+/// integral and floating-point types). An empty string is an empty list.
+///
+/// @return iterator past the last value written on success,
+/// ConvertListError with the index of the element that failed otherwise
+template<typename T, KiloMultiplier kilo = KiloMultiplier::none, std::output_iterator<T> O>
+constexpr auto convert_list(std::string_view sv, char delimiter, O out) -> std::expected<O, ConvertListError> {
+	if (sv.empty()) {
+		return out;
+	}
+
+	for (std::size_t index = 0; ; ++index) {
+		auto element_end = sv.find(delimiter);
+
+		auto element = sv.substr(0, element_end);
+
+		std::expected<T, std::errc> value;
+
+		if constexpr (std::same_as<std::remove_cv_t<T>, bool>) {
+			value = convert_to<T>(element);
+		}
+		else {
+			value = convert_to<T, kilo>(element);
+		}
+
+		if (!value) {
+			return std::unexpected(ConvertListError{index, value.error()});
+		}
+
+		*out = *value;
+		++out;
+
+		if (element_end == std::string_view::npos) {
+			break;
+		}
+
+		sv.remove_prefix(element_end + 1);
+	}
+
+	return out;
+}
+
+/// @brief Convert a list of values separated by `delimiter` to type `T`,
+/// appending them to `values`.
+///
+/// Reserves space for all elements first. On error, `values` contains
+/// the values before the element that failed.
+///
+/// @return nothing on success, ConvertListError with the index of the
+/// element that failed otherwise
+template<typename T, KiloMultiplier kilo = KiloMultiplier::none, typename Allocator>
+constexpr auto convert_list(std::string_view sv, char delimiter, std::vector<T, Allocator> &values) -> std::expected<void, ConvertListError> {
+	if (!sv.empty()) {
+		values.reserve(values.size() + static_cast<std::size_t>(std::ranges::count(sv, delimiter)) + 1);
+	}
+
+	if (auto res = convert_list<T, kilo>(sv, delimiter, std::back_inserter(values)); !res) {
+		return std::unexpected(res.error());
+	}
+
+	return {};
+}
+
+namespace detail {
+
+constexpr auto is_command_line_space(char c) -> bool {
+	return c == ' ' || c == '\t' || c == '\n';
+}
+
+constexpr auto is_command_line_special(char c) -> bool {
+	return is_command_line_space(c) || c == '\'' || c == '"' || c == '\\';
+}
+
+// Bit 7 of each byte is set if the character is a control character or
+// space, a quote or a backslash
+constexpr auto swar_command_line_candidates(std::uint64_t x) -> std::uint64_t {
+	constexpr std::uint64_t high = 0x8080808080808080ULL;
+	constexpr std::uint64_t ones = 0x0101010101010101ULL;
+
+	auto equal = [&](char c) {
+		return ~swar_nonzero_bytes(x ^ (ones * static_cast<unsigned char>(c))) & high;
+	};
+
+	// Setting bit 7 first keeps borrows within each byte
+	std::uint64_t less_than_bang = ~((x | high) - ones * 0x21) & ~x & high;
+
+	return less_than_bang | equal('\'') | equal('"') | equal('\\');
+}
+
+/// @brief Find first whitespace, quote or backslash in [p, end).
+inline auto find_command_line_special(const char *p, const char *end) -> const char * {
+	if constexpr (std::endian::native == std::endian::little) {
+		while (end - p >= 8) {
+			std::uint64_t x = 0;
+
+			std::memcpy(&x, p, 8);
+
+			if (auto mask = swar_command_line_candidates(x); mask != 0) {
+				p += std::countr_zero(mask) / 8;
+
+				// Other control characters are not special
+				if (is_command_line_special(*p)) {
+					return p;
+				}
+
+				++p;
+			}
+			else {
+				p += 8;
+			}
+		}
+	}
+
+	while (p != end && !is_command_line_special(*p)) {
+		++p;
+	}
+
+	return p;
+}
+
+/// @brief Find end of argument containing quotes or backslashes.
+///
+/// @param p position of first quote or backslash in the argument
+/// @return end of argument, or ParseError if a quote is not closed
+inline auto find_quoted_argument_end(std::string_view command_line, const char *p) -> std::expected<const char *, ParseError> {
+	const char *end = command_line.data() + command_line.size();
+
+	auto fail = [&](const char *where, std::string_view what) -> std::expected<const char *, ParseError> {
+		auto pos = static_cast<std::size_t>(where - command_line.data());
+
+		return std::unexpected<ParseError>(std::in_place, pos,
+			std::format("{} at position {}", what, pos)
+		);
+	};
+
+	while (p != end && !is_command_line_space(*p)) {
+		switch (*p) {
+		case '\\':
+			if (++p == end) {
+				return fail(p - 1, "backslash at end of command line");
+			}
+
+			++p;
+			break;
+		case '\'':
+			if (auto close = std::find(p + 1, end, '\''); close != end) {
+				p = close + 1;
+			}
+			else {
+				return fail(p, "unterminated single quote");
+			}
+			break;
+		case '"': {
+			const char *open = p++;
+
+			while (p != end && *p != '"') {
+				if (*p == '\\' && p + 1 != end) {
+					++p;
+				}
+
+				++p;
+			}
+
+			if (p == end) {
+				return fail(open, "unterminated double quote");
+			}
+
+			++p;
+			break;
+		}
+		default:
+			p = find_command_line_special(p, end);
+			break;
+		}
+	}
+
+	return p;
+}
+
+/// @brief Remove quotes and backslashes from argument in [p, end).
+///
+/// The argument must be validated by `find_quoted_argument_end()`.
+///
+/// @return end of unescaped argument in `out`
+inline auto unescape_argument(const char *p, const char *end, char *out) -> char * {
+	while (p != end) {
+		switch (*p) {
+		case '\\':
+			// Backslash newline is a line continuation
+			if (*++p != '\n') {
+				*out++ = *p;
+			}
+
+			++p;
+			break;
+		case '\'':
+			for (++p; *p != '\''; ++p) {
+				*out++ = *p;
+			}
+
+			++p;
+			break;
+		case '"':
+			for (++p; *p != '"'; ++p) {
+				// In double quotes, backslash only escapes these
+				if (*p == '\\' && std::string_view("$`\"\\\n").contains(p[1])) {
+					if (*++p == '\n') {
+						continue;
+					}
+				}
+
+				*out++ = *p;
+			}
+
+			++p;
+			break;
+		default:
+			*out++ = *p++;
+			break;
+		}
+	}
+
+	return out;
+}
+
+} // namespace detail
+
+/// @brief Split `command_line` into arguments like a POSIX shell.
+///
+/// Arguments are separated by spaces, tabs and newlines. Quoting works
+/// like in the POSIX shell: a backslash escapes the next character,
+/// single quotes preserve all characters up to the closing quote, and in
+/// double quotes a backslash only escapes '$', '`', '"', '\' and newline.
+/// A backslash followed by newline is removed. There are no expansions,
+/// comments or operators, so other characters are taken literally.
+///
+/// Arguments without quotes or backslashes refer to `command_line`. Only
+/// arguments that need unescaping are copied, into memory allocated from
+/// `arena`, which is also used for the returned vector. The result can be
+/// parsed directly by `parse()`.
+///
+///     std::pmr::monotonic_buffer_resource arena;
+///
+///     auto args = cpparg::split_command_line("cc -o 'my app' main.c", &arena);
+///
+/// Unescaped arguments are never deallocated individually, so `arena`
+/// should be a resource that releases its memory as a whole, like
+/// `std::pmr::monotonic_buffer_resource`.
+///
+/// @note Ensure that the result does not outlive `command_line` or
+/// `arena`.
+///
+/// @param arena memory resource for the result and unescaped arguments
+/// @return vector of arguments on success, ParseError with the position
+/// in `command_line` of the unterminated quote or backslash otherwise
+inline auto split_command_line(std::string_view command_line, std::pmr::memory_resource *arena)
+	-> std::expected<std::pmr::vector<std::string_view>, ParseError> {
+	std::pmr::vector<std::string_view> args(arena);
+
+	const char *p = command_line.data();
+	const char *end = p + command_line.size();
+
+	for (;;) {
+		// Skip whitespace and line continuations between arguments
+		while (p != end && (detail::is_command_line_space(*p) || (*p == '\\' && p + 1 != end && p[1] == '\n'))) {
+			p += *p == '\\' ? 2 : 1;
+		}
+
+		if (p == end) {
+			break;
+		}
+
+		const char *start = p;
+
+		p = detail::find_command_line_special(p, end);
+
+		if (p == end || detail::is_command_line_space(*p)) {
+			args.emplace_back(start, static_cast<std::size_t>(p - start));
+
+			continue;
+		}
+
+		auto arg_end = detail::find_quoted_argument_end(command_line, p);
+
+		if (!arg_end) {
+			return std::unexpected(std::move(arg_end.error()));
+		}
+
+		p = *arg_end;
+
+		// Unescaped argument is no longer than the original
+		auto *buffer = static_cast<char *>(arena->allocate(static_cast<std::size_t>(p - start), 1));
+
+		auto *buffer_end = detail::unescape_argument(start, p, buffer);
+
+		args.emplace_back(buffer, static_cast<std::size_t>(buffer_end - buffer));
+	}
+
+	return args;
+}
+
 } // namespace cpparg
 
 #endif // CPPARG_HPP_INCLUDED
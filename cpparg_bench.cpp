@@ -0,0 +1,1442 @@
+//
+// cpparg - C++ parse argv
+//
+// Copyright 2025 Joergen Ibsen
+//
+// Permission is hereby granted, free of charge, to any person obtaining a
+// copy of this software and associated documentation files (the "Software"),
+// to deal in the Software without restriction, including without limitation
+// the rights to use, copy, modify, merge, publish, distribute, sublicense,
+// and/or sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+// THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+// FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+//
+// SPDX-License-Identifier: MIT-0
+//
+
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory_resource>
+#include <optional>
+#include <print>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "cpparg.hpp"
+
+namespace {
+
+enum struct OutputFormat {
+	text,
+	csv,
+	json
+};
+
+// Settings from command line
+struct Settings {
+	OutputFormat format = OutputFormat::text;
+	std::chrono::nanoseconds min_time = std::chrono::milliseconds(200);
+	std::vector<std::string> filters;
+	bool quick = false;
+} settings;
+
+// Time of one benchmark, where `items` is the number of elements,
+// queries or similar processed per call, and `allocations` the number of
+// allocations per call if measured
+struct Measurement {
+	std::string benchmark;
+	std::string variant;
+	std::size_t items = 0;
+	std::chrono::nanoseconds time_per_call{};
+	std::optional<double> allocations;
+};
+
+std::vector<Measurement> measurements;
+
+auto json_string(std::string_view sv) -> std::string {
+	std::string res = "\"";
+
+	for (char ch : sv) {
+		if (ch == '"' || ch == '\\') {
+			res.push_back('\\');
+		}
+
+		res.push_back(ch);
+	}
+
+	res.push_back('"');
+
+	return res;
+}
+
+auto csv_string(std::string_view sv) -> std::string {
+	std::string res = "\"";
+
+	for (char ch : sv) {
+		if (ch == '"') {
+			res.push_back('"');
+		}
+
+		res.push_back(ch);
+	}
+
+	res.push_back('"');
+
+	return res;
+}
+
+auto ns_per_item(const Measurement &m) -> double {
+	return static_cast<double>(m.time_per_call.count()) / static_cast<double>(std::max<std::size_t>(m.items, 1));
+}
+
+auto allocations_string(const Measurement &m, std::string_view none) -> std::string {
+	return m.allocations ? std::format("{:.1f}", *m.allocations) : std::string(none);
+}
+
+auto report(std::string_view benchmark, std::string variant, std::size_t items, std::chrono::nanoseconds time_per_call,
+            std::optional<double> allocations = {}) -> void {
+	measurements.push_back({std::string(benchmark), std::move(variant), items, time_per_call, allocations});
+
+	if (settings.format == OutputFormat::text) {
+		const auto &m = measurements.back();
+
+		std::println("{:<16} {:<50} {:>10} {:>14} {:>10.1f} {:>12}", m.benchmark, m.variant,
+			m.items, m.time_per_call.count(), ns_per_item(m), allocations_string(m, "-"));
+	}
+}
+
+auto print_measurements() -> void {
+	if (settings.format == OutputFormat::csv) {
+		std::println("benchmark,variant,items,ns_per_call,ns_per_item,allocations_per_call");
+
+		for (const auto &m : measurements) {
+			std::println("{},{},{},{},{:.2f},{}", csv_string(m.benchmark), csv_string(m.variant), m.items,
+				m.time_per_call.count(), ns_per_item(m), allocations_string(m, ""));
+		}
+	}
+	else if (settings.format == OutputFormat::json) {
+		std::println("[");
+
+		for (std::size_t i = 0; i < measurements.size(); ++i) {
+			const auto &m = measurements[i];
+
+			std::println("  {{\"benchmark\": {}, \"variant\": {}, \"items\": {}, \"ns_per_call\": {}, \"ns_per_item\": {:.2f}, \"allocations_per_call\": {}}}{}",
+				json_string(m.benchmark), json_string(m.variant), m.items,
+				m.time_per_call.count(), ns_per_item(m), allocations_string(m, "null"),
+				i + 1 < measurements.size() ? "," : "");
+		}
+
+		std::println("]");
+	}
+}
+
+// Check if benchmark `name` was selected on the command line
+auto selected(std::string_view name) -> bool {
+	if (settings.filters.empty()) {
+		return true;
+	}
+
+	return std::ranges::any_of(settings.filters, [&](const auto &filter) {
+		return name.find(filter) != std::string_view::npos;
+	});
+}
+
+// Simple deterministic pseudo-random number generator, so runs are
+// comparable between builds
+struct Lcg {
+	std::uint64_t state = 0x2545F4914F6CDD1DULL;
+
+	auto operator()(std::uint64_t bound) -> std::uint64_t {
+		state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+
+		return (state >> 33) % bound;
+	}
+};
+
+constexpr auto short_flag_char(std::size_t i) -> char {
+	return static_cast<char>(i < 26 ? 'a' + i : 'A' + i - 26);
+}
+
+// Parser with options "option-0" to "option-N", where odd options take
+// an argument. The first 52 even options also have a short flag.
+auto make_parser(std::size_t num_options) -> cpparg::OptionParser {
+	cpparg::OptionParser parser;
+
+	for (std::size_t i = 0; i < num_options; ++i) {
+		std::string short_flag;
+
+		if (i % 2 == 0 && i / 2 < 52) {
+			short_flag.push_back(short_flag_char(i / 2));
+		}
+
+		parser.add_option(short_flag, std::format("option-{}", i), i % 2 ? "ARG" : "", "");
+	}
+
+	return parser;
+}
+
+// Run `fn` repeatedly for at least the minimum time, return average time
+// per call
+template<typename Fn>
+auto time_per_call(Fn &&fn) -> std::chrono::nanoseconds {
+	using clock = std::chrono::steady_clock;
+
+	std::size_t calls = 0;
+
+	auto start = clock::now();
+	auto elapsed = clock::duration::zero();
+
+	do {
+		fn();
+		++calls;
+		elapsed = clock::now() - start;
+	} while (elapsed < settings.min_time);
+
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed) / calls;
+}
+
+template<typename Result>
+auto check_result(const Result &result) -> void {
+	if (!result) {
+		std::println(stderr, "error: {}", result.error().what);
+	}
+}
+
+enum struct ArgForm {
+	separate,
+	inline_value,
+	short_cluster
+};
+
+constexpr std::array arg_forms = {
+	std::pair{ArgForm::separate, "--flag value"},
+	std::pair{ArgForm::inline_value, "--flag=value"},
+	std::pair{ArgForm::short_cluster, "-abcdefgh"}
+};
+
+// Generate `num_args` elements of form `form` for parser from
+// `make_parser(num_options)`
+auto make_args(std::size_t num_options, ArgForm form, std::size_t num_args) -> std::vector<std::string> {
+	Lcg rng;
+
+	std::vector<std::string> args;
+
+	args.reserve(num_args);
+
+	auto num_short = std::min<std::size_t>((num_options + 1) / 2, 52);
+
+	while (args.size() < num_args) {
+		auto i = rng(num_options / 2) * 2 + 1;
+
+		switch (form) {
+		case ArgForm::separate:
+			args.push_back(std::format("--option-{}", i));
+			args.push_back("value");
+			break;
+		case ArgForm::inline_value:
+			args.push_back(std::format("--option-{}=value", i));
+			break;
+		case ArgForm::short_cluster: {
+			std::string arg = "-";
+
+			while (arg.size() < 9) {
+				arg.push_back(short_flag_char(rng(num_short)));
+			}
+
+			args.push_back(std::move(arg));
+			break;
+		}
+		}
+	}
+
+	// A separate argument may have been cut off
+	if (args.size() > num_args) {
+		args.resize(num_args);
+		args.back() = "positional";
+	}
+
+	return args;
+}
+
+// Parse a grid of option counts, argument forms and element counts
+auto bench_parse_grid() -> void {
+	std::vector<std::size_t> option_counts = {10, 100, 1'000, 10'000};
+	std::vector<std::size_t> arg_counts = {1, 100, 10'000, 1'000'000};
+
+	if (settings.quick) {
+		option_counts.pop_back();
+		arg_counts.pop_back();
+	}
+
+	for (auto num_options : option_counts) {
+		auto parser = make_parser(num_options);
+
+		for (auto [form, form_name] : arg_forms) {
+			for (auto num_args : arg_counts) {
+				auto args = make_args(num_options, form, num_args);
+
+				auto ns = time_per_call([&] {
+					check_result(parser.parse(args.begin(), args.end()));
+				});
+
+				report("parse", std::format("{} options, {}, {} elements", num_options, form_name, num_args), num_args, ns);
+			}
+		}
+	}
+}
+
+// Parse elements consisting of clusters of short options of varying
+// length, reported per flag
+auto bench_short_clusters() -> void {
+	constexpr std::size_t num_args = 10'000;
+
+	cpparg::OptionParser parser;
+
+	for (std::size_t i = 0; i < 52; ++i) {
+		parser.add_option(std::string(1, short_flag_char(i)), "", "", "");
+	}
+
+	for (std::size_t cluster_len : {1, 8, 64}) {
+		Lcg rng;
+
+		std::vector<std::string> args;
+
+		while (args.size() < num_args) {
+			std::string arg = "-";
+
+			while (arg.size() <= cluster_len) {
+				arg.push_back(short_flag_char(rng(52)));
+			}
+
+			args.push_back(std::move(arg));
+		}
+
+		auto ns = time_per_call([&] {
+			check_result(parser.parse(args.begin(), args.end()));
+		});
+
+		report("short_clusters", std::format("{} flags per element", cluster_len), num_args * cluster_len, ns);
+	}
+}
+
+// Parse many positional arguments into an owning and a view result, and
+// through a visitor
+auto bench_positional_arguments() -> void {
+	constexpr std::size_t num_args = 200'000;
+
+	auto parser = make_parser(10);
+
+	std::vector<std::string> args;
+
+	for (std::size_t i = 0; i < num_args; ++i) {
+		args.push_back(std::format("/some/path/to/input/file-{}.txt", i));
+	}
+
+	auto ns = time_per_call([&] {
+		check_result(parser.parse<cpparg::ParseResult>(args.begin(), args.end()));
+	});
+
+	report("positional", "ParseResult", num_args, ns);
+
+	ns = time_per_call([&] {
+		check_result(parser.parse<cpparg::ParseResultView>(args.begin(), args.end()));
+	});
+
+	report("positional", "ParseResultView", num_args, ns);
+
+	std::size_t total_size = 0;
+
+	ns = time_per_call([&] {
+		check_result(parser.parse_with(args.begin(), args.end(), [&](const cpparg::ParseEvent &event) {
+			total_size += event.argument->size();
+		}));
+	});
+
+	report("positional", "parse_with", num_args, ns);
+
+	if (total_size == 0) {
+		std::println(stderr, "no arguments visited");
+	}
+}
+
+// Parse a mix of options and positional arguments into a result using
+// the global heap, and into a result using a monotonic arena
+auto bench_arena() -> void {
+	constexpr std::size_t num_args = 1'000;
+
+	auto parser = make_parser(100);
+
+	Lcg rng;
+
+	std::vector<std::string> args;
+
+	while (args.size() < num_args) {
+		auto i = rng(100);
+
+		if (i % 2) {
+			args.push_back(std::format("--option-{}=argument-value-{}", i, args.size()));
+		}
+		else if (i % 3 == 0) {
+			args.push_back(std::format("--option-{}", i));
+		}
+		else {
+			args.push_back(std::format("/path/to/positional/argument-{}", args.size()));
+		}
+	}
+
+	auto ns = time_per_call([&] {
+		check_result(parser.parse<cpparg::ParseResult>(args.begin(), args.end()));
+	});
+
+	report("arena", "ParseResult", num_args, ns);
+
+	std::vector<std::byte> buffer(1 << 20);
+
+	ns = time_per_call([&] {
+		std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+
+		check_result(parser.parse<cpparg::pmr::ParseResult>(args.begin(), args.end(), &arena));
+	});
+
+	report("arena", "pmr::ParseResult (arena)", num_args, ns);
+}
+
+// Query every option of a result by name and by OptionId
+auto bench_queries() -> void {
+	for (std::size_t num_options : {10, 300, 10'000}) {
+		cpparg::OptionParser parser;
+
+		std::vector<std::string> names;
+		std::vector<cpparg::OptionId> ids;
+
+		for (std::size_t i = 0; i < num_options; ++i) {
+			names.push_back(std::format("config-option-{}", i));
+			ids.push_back(parser.add_option_with_id("", names.back(), "VALUE", ""));
+		}
+
+		// Half of the options occur
+		std::vector<std::string> args;
+
+		for (std::size_t i = 0; i < num_options; i += 2) {
+			args.push_back(std::format("--{}={}", names[i], i));
+		}
+
+		auto result = parser.parse(args.begin(), args.end());
+
+		check_result(result);
+
+		std::size_t sink = 0;
+
+		auto ns = time_per_call([&] {
+			for (const auto &name : names) {
+				sink += result->get_arguments_for_option(name).size();
+			}
+		});
+
+		report("query", std::format("{} options, get_arguments_for_option(name)", num_options), num_options, ns);
+
+		ns = time_per_call([&] {
+			for (auto id : ids) {
+				sink += result->get_arguments_for_option(id).size();
+			}
+		});
+
+		report("query", std::format("{} options, get_arguments_for_option(id)", num_options), num_options, ns);
+
+		ns = time_per_call([&] {
+			for (const auto &name : names) {
+				sink += result->contains(name);
+			}
+		});
+
+		report("query", std::format("{} options, contains(name)", num_options), num_options, ns);
+
+		ns = time_per_call([&] {
+			for (const auto &name : names) {
+				sink += result->get_last_argument_for_option(name).has_value();
+			}
+		});
+
+		report("query", std::format("{} options, get_last_argument_for_option(name)", num_options), num_options, ns);
+
+		if (sink == 0) {
+			std::println(stderr, "unexpected empty result");
+		}
+	}
+}
+
+// Generate help for options with descriptions of varying length at
+// different line widths
+auto bench_help() -> void {
+	constexpr std::size_t num_options = 100;
+
+	constexpr std::string_view words[] = {
+		"enable", "the", "processing", "of", "input", "files", "with",
+		"optional", "compression", "and", "a", "very-long-hyphenated-word"
+	};
+
+	cpparg::OptionParser parser;
+
+	Lcg rng;
+
+	for (std::size_t i = 0; i < num_options; ++i) {
+		std::string description;
+
+		for (std::size_t j = 0, num_words = 1 + rng(40); j < num_words; ++j) {
+			if (!description.empty()) {
+				description.push_back(' ');
+			}
+
+			description.append(words[rng(std::size(words))]);
+		}
+
+		std::string short_flag(i < 52 ? 1 : 0, short_flag_char(i));
+
+		parser.add_option(short_flag, std::format("help-option-{}", i), i % 3 ? "ARG" : "", description);
+	}
+
+	for (std::size_t width : {0, 40, 80, 120, 200}) {
+		std::size_t total_size = 0;
+
+		auto ns = time_per_call([&] {
+			total_size += parser.get_option_help(width).size();
+		});
+
+		report("help", std::format("width {}", width), num_options, ns);
+
+		if (total_size == 0) {
+			std::println(stderr, "unexpected empty help");
+		}
+	}
+
+	std::FILE *f = std::tmpfile();
+
+	if (f == nullptr) {
+		std::println(stderr, "unable to create temporary file");
+
+		return;
+	}
+
+	for (std::size_t width : {0, 80}) {
+		auto ns = time_per_call([&] {
+			std::rewind(f);
+
+			std::fputs(parser.get_option_help(width).c_str(), f);
+		});
+
+		report("help", std::format("get_option_help to FILE, width {}", width), num_options, ns);
+
+		ns = time_per_call([&] {
+			std::rewind(f);
+
+			if (!parser.format_option_help_to(f, width)) {
+				std::println(stderr, "error writing help");
+			}
+		});
+
+		report("help", std::format("format_option_help_to FILE, width {}", width), num_options, ns);
+	}
+
+	std::fclose(f);
+}
+
+// Convert `strings` to `T` in `base`
+template<typename T>
+auto bench_convert_type(std::string_view type_name, int base, const std::vector<std::string> &strings) -> void {
+	std::size_t sink = 0;
+
+	auto ns = time_per_call([&] {
+		for (const auto &s : strings) {
+			if (auto value = cpparg::convert_to<T>(s, base)) {
+				sink += static_cast<std::size_t>(*value);
+			}
+		}
+	});
+
+	report("convert_to", std::format("{}, base {}", type_name, base), strings.size(), ns);
+
+	if (sink == 42) {
+		std::println(stderr, "unlikely sum");
+	}
+}
+
+// Generate strings of random values below `limit` in `base`
+auto make_numbers(std::uint64_t limit, int base, bool allow_negative) -> std::vector<std::string> {
+	constexpr std::size_t num_values = 10'000;
+
+	Lcg rng;
+
+	std::vector<std::string> strings;
+
+	for (std::size_t i = 0; i < num_values; ++i) {
+		auto value = rng(limit);
+
+		std::array<char, 80> buf;
+
+		auto [ptr, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value, base);
+
+		std::string s(buf.data(), ptr);
+
+		if (allow_negative && rng(2) == 0) {
+			s.insert(0, 1, '-');
+		}
+
+		strings.push_back(std::move(s));
+	}
+
+	return strings;
+}
+
+template<typename T>
+auto bench_convert_integral(std::string_view type_name) -> void {
+	// Limit values to the range of the type, and the range of Lcg
+	auto limit = std::min<std::uint64_t>(static_cast<std::uint64_t>(std::numeric_limits<T>::max()), 1ULL << 31);
+
+	for (int base : {2, 8, 10, 16, 36}) {
+		auto strings = make_numbers(limit, base, std::is_signed_v<T>);
+
+		bench_convert_type<T>(type_name, base, strings);
+	}
+}
+
+auto bench_convert() -> void {
+	bench_convert_integral<std::int8_t>("int8_t");
+	bench_convert_integral<std::uint8_t>("uint8_t");
+	bench_convert_integral<std::int16_t>("int16_t");
+	bench_convert_integral<std::uint16_t>("uint16_t");
+	bench_convert_integral<std::int32_t>("int32_t");
+	bench_convert_integral<std::uint32_t>("uint32_t");
+	bench_convert_integral<std::int64_t>("int64_t");
+	bench_convert_integral<std::uint64_t>("uint64_t");
+
+	// Kilo multiplier suffixes
+	{
+		Lcg rng;
+
+		std::vector<std::string> strings;
+
+		for (std::size_t i = 0; i < 10'000; ++i) {
+			strings.push_back(std::format("{}{}", rng(1000), "KMG"[rng(3)]));
+		}
+
+		std::size_t sink = 0;
+
+		auto ns = time_per_call([&] {
+			for (const auto &s : strings) {
+				if (auto value = cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>(s)) {
+					sink += static_cast<std::size_t>(*value);
+				}
+			}
+		});
+
+		report("convert_to", "int64_t, base 10, KiloMultiplier::binary", strings.size(), ns);
+
+		if (sink == 42) {
+			std::println(stderr, "unlikely sum");
+		}
+	}
+
+	// Bool
+	{
+		constexpr std::array<const char *, 8> values = {
+			"yes", "no", "true", "false", "on", "off", "1", "0"
+		};
+
+		Lcg rng;
+
+		std::vector<std::string> strings;
+
+		for (std::size_t i = 0; i < 10'000; ++i) {
+			strings.emplace_back(values[rng(values.size())]);
+		}
+
+		std::size_t sink = 0;
+
+		auto ns = time_per_call([&] {
+			for (const auto &s : strings) {
+				sink += cpparg::convert_to<bool>(s).value_or(false);
+			}
+		});
+
+		report("convert_to", "bool", strings.size(), ns);
+
+		if (sink == 0) {
+			std::println(stderr, "unexpected all false");
+		}
+	}
+}
+
+// Memory resource that counts allocations
+struct CountingResource : std::pmr::memory_resource {
+	std::size_t allocations = 0;
+
+	auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override {
+		++allocations;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+
+	auto do_deallocate(void *p, std::size_t bytes, std::size_t alignment) -> void override {
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+
+	auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override {
+		return this == &other;
+	}
+};
+
+// Run `fn` like time_per_call(), and count allocations from `resource`
+// per call after the first calls
+template<typename Fn>
+auto time_and_allocations_per_call(CountingResource &resource, Fn &&fn) -> std::pair<std::chrono::nanoseconds, double> {
+	// Warm up
+	for (int i = 0; i < 2; ++i) {
+		fn();
+	}
+
+	resource.allocations = 0;
+
+	std::size_t calls = 0;
+
+	auto ns = time_per_call([&] {
+		fn();
+		++calls;
+	});
+
+	return {ns, static_cast<double>(resource.allocations) / static_cast<double>(calls)};
+}
+
+// Parse into a new result each time, and into a reused result, counting
+// allocations per parse after warm up
+auto bench_parse_into() -> void {
+	constexpr std::size_t num_args = 1'000;
+
+	auto parser = make_parser(100);
+
+	Lcg rng;
+
+	std::vector<std::string> args;
+
+	while (args.size() < num_args) {
+		auto i = rng(100);
+
+		if (i % 2) {
+			args.push_back(std::format("--option-{}=value-{}", i, rng(100)));
+		}
+		else {
+			args.push_back(std::format("--option-{}", i));
+		}
+	}
+
+	auto bench_result = [&]<typename Result>(std::string_view name) {
+		CountingResource resource;
+
+		auto [ns, allocations] = time_and_allocations_per_call(resource, [&] {
+			check_result(parser.parse<Result>(args.begin(), args.end(), &resource));
+		});
+
+		report("parse_into", std::format("{}, parse", name), num_args, ns, allocations);
+
+		Result result(&resource);
+
+		std::tie(ns, allocations) = time_and_allocations_per_call(resource, [&] {
+			check_result(parser.parse_into(result, args.begin(), args.end()));
+		});
+
+		report("parse_into", std::format("{}, parse_into", name), num_args, ns, allocations);
+	};
+
+	bench_result.operator()<cpparg::pmr::ParseResult>("pmr::ParseResult");
+	bench_result.operator()<cpparg::pmr::ParseResultView>("pmr::ParseResultView");
+}
+
+// Parse options with integer arguments and get the values, by querying the
+// result and converting, and by binding variables
+auto bench_bind() -> void {
+	constexpr std::size_t num_values = 8;
+
+	std::array<std::string, num_values> names;
+	std::array<std::uint32_t, num_values> values{};
+
+	cpparg::OptionParser parser;
+
+	for (std::size_t i = 0; i < num_values; ++i) {
+		names[i] = std::format("value-{}", i);
+
+		parser.add_option("", names[i], "=N", "value").bind(values[i]);
+	}
+
+	cpparg::OptionParser unbound_parser;
+
+	for (const auto &name : names) {
+		unbound_parser.add_option("", name, "=N", "value");
+	}
+
+	Lcg rng;
+
+	std::vector<std::string> args;
+
+	for (const auto &name : names) {
+		args.push_back(std::format("--{}={}", name, rng(1'000'000)));
+	}
+
+	std::uint64_t sink = 0;
+
+	auto ns = time_per_call([&] {
+		auto result = unbound_parser.parse(args.begin(), args.end());
+
+		check_result(result);
+
+		for (const auto &name : names) {
+			auto arg = result->get_last_argument_for_option(name).value_or("0");
+
+			sink += cpparg::convert_to<std::uint32_t>(arg).value_or(0);
+		}
+	});
+
+	report("bind", "parse, get_last_argument_for_option, convert_to", num_values, ns);
+
+	ns = time_per_call([&] {
+		check_result(parser.parse<cpparg::ParseResultView>(args.begin(), args.end()));
+
+		for (auto value : values) {
+			sink += value;
+		}
+	});
+
+	report("bind", "parse<ParseResultView>, bind", num_values, ns);
+
+	if (sink == 42) {
+		std::println(stderr, "unlikely sum");
+	}
+}
+
+// Add options from an environment with one scan, and by looking up each
+// option like getenv does
+auto bench_environment() -> void {
+	constexpr std::size_t num_options = 50;
+	constexpr std::size_t num_vars = 200;
+
+	cpparg::OptionParser parser;
+
+	std::vector<std::string> names;
+
+	for (std::size_t i = 0; i < num_options; ++i) {
+		names.push_back(std::format("option-{}", i));
+
+		parser.add_option("", names.back(), "=ARG", "option");
+	}
+
+	parser.set_env_prefix("APP");
+
+	std::vector<std::string> vars;
+
+	for (std::size_t i = 0; i < num_vars; ++i) {
+		vars.push_back(i % 8 == 0 ? std::format("APP_OPTION_{}=value", i / 8)
+		                          : std::format("VARIABLE_{}=value", i));
+	}
+
+	std::vector<const char *> envp;
+
+	for (const auto &var : vars) {
+		envp.push_back(var.c_str());
+	}
+
+	envp.push_back(nullptr);
+
+	cpparg::ParseResultView result;
+
+	auto ns = time_per_call([&] {
+		result.clear();
+
+		check_result(parser.merge_environment(result, envp.data()));
+	});
+
+	report("environment", "merge_environment", num_vars, ns);
+
+	// Linear search for each variable, like getenv
+	auto find_variable = [&](std::string_view name) -> const char * {
+		for (const char *var : envp) {
+			std::string_view sv(var ? var : "");
+
+			if (sv.starts_with(name) && sv.substr(name.size()).starts_with('=')) {
+				return var + name.size() + 1;
+			}
+		}
+
+		return nullptr;
+	};
+
+	std::vector<std::string> var_names;
+
+	for (std::size_t i = 0; i < num_options; ++i) {
+		var_names.push_back(std::format("APP_OPTION_{}", i));
+	}
+
+	ns = time_per_call([&] {
+		result.clear();
+
+		for (std::size_t i = 0; i < num_options; ++i) {
+			if (auto *value = find_variable(var_names[i])) {
+				auto id = parser.find_option_id(names[i]);
+
+				if (!result.contains(*id)) {
+					result.add_parsed_option(*id, names[i], value);
+				}
+			}
+		}
+	});
+
+	report("environment", "lookup per option", num_vars, ns);
+}
+
+// Create a parser with 40 subcommands and parse a command line using one,
+// with subcommand parsers created up front and lazily
+auto bench_subcommands() -> void {
+	static constexpr std::size_t num_subcommands = 40;
+	static constexpr std::size_t num_options = 30;
+
+	std::vector<std::string> names;
+
+	for (std::size_t i = 0; i < num_subcommands; ++i) {
+		names.push_back(std::format("command-{}", i));
+	}
+
+	std::array args = { "--option-0", "command-7", "--option-1=value", "file" };
+
+	auto ns = time_per_call([&] {
+		auto parser = make_parser(num_options);
+
+		std::vector<cpparg::OptionParser> subcommand_parsers;
+
+		for (std::size_t i = 0; i < num_subcommands; ++i) {
+			subcommand_parsers.push_back(make_parser(num_options));
+		}
+
+		auto result = parser.parse<cpparg::ParseResultView>(args.begin(), args.begin() + 2);
+
+		check_result(result);
+
+		check_result(subcommand_parsers[7].parse<cpparg::ParseResultView>(args.begin() + 2, args.end()));
+	});
+
+	report("subcommands", "create all parsers, parse", args.size(), ns);
+
+	ns = time_per_call([&] {
+		auto parser = make_parser(num_options);
+
+		for (const auto &name : names) {
+			parser.add_subcommand(name, [] { return make_parser(num_options); });
+		}
+
+		check_result(parser.parse<cpparg::ParseResultView>(args.begin(), args.end()));
+	});
+
+	report("subcommands", "add_subcommand, parse", args.size(), ns);
+}
+
+// Word wrap a long text to different line widths
+auto bench_word_wrap() -> void {
+	constexpr std::size_t text_size = 8192;
+
+	constexpr std::string_view words[] = {
+		"enable", "the", "processing", "of", "input", "files", "with",
+		"optional", "compression", "and", "a", "very-long-hyphenated-word"
+	};
+
+	Lcg rng;
+
+	std::string text;
+
+	while (text.size() < text_size) {
+		text.append(words[rng(std::size(words))]);
+		text.append(rng(8) ? " " : "  ");
+	}
+
+	for (std::size_t width : {40, 80, 200}) {
+		std::size_t num_lines = 0;
+
+		auto ns = time_per_call([&] {
+			for (auto line : cpparg::word_wrap(text, width)) {
+				num_lines += line.size() != 0;
+			}
+		});
+
+		report("word_wrap", std::format("width {}", width), text.size(), ns);
+
+		if (num_lines == 0) {
+			std::println(stderr, "unexpected empty text");
+		}
+	}
+}
+
+// Convert full range 64-bit values with convert_to, std::from_chars and
+// std::strtoull
+auto bench_convert_compare() -> void {
+	constexpr std::size_t num_values = 10'000;
+
+	for (int base : {10, 16}) {
+		Lcg rng;
+
+		std::vector<std::string> strings;
+
+		for (std::size_t i = 0; i < num_values; ++i) {
+			auto value = (rng(1ULL << 32) << 32 | rng(1ULL << 32)) >> rng(64);
+
+			std::array<char, 80> buf;
+
+			auto [ptr, ec] = std::to_chars(buf.data(), buf.data() + buf.size(), value, base);
+
+			strings.emplace_back(buf.data(), ptr);
+		}
+
+		std::uint64_t sink = 0;
+
+		auto ns = time_per_call([&] {
+			for (const auto &s : strings) {
+				sink += cpparg::convert_to<std::uint64_t>(s, base).value_or(0);
+			}
+		});
+
+		report("convert_compare", std::format("convert_to<uint64_t>, base {}", base), num_values, ns);
+
+		ns = time_per_call([&] {
+			for (const auto &s : strings) {
+				std::uint64_t value = 0;
+
+				std::from_chars(s.data(), s.data() + s.size(), value, base);
+
+				sink += value;
+			}
+		});
+
+		report("convert_compare", std::format("std::from_chars, base {}", base), num_values, ns);
+
+		ns = time_per_call([&] {
+			for (const auto &s : strings) {
+				sink += std::strtoull(s.c_str(), nullptr, base);
+			}
+		});
+
+		report("convert_compare", std::format("std::strtoull, base {}", base), num_values, ns);
+
+		if (sink == 42) {
+			std::println(stderr, "unlikely sum");
+		}
+	}
+}
+
+// Convert floating-point values with convert_to and std::strtod
+auto bench_convert_floating() -> void {
+	constexpr std::size_t num_values = 10'000;
+
+	Lcg rng;
+
+	std::vector<std::string> strings;
+	std::vector<std::string> suffixed;
+
+	for (std::size_t i = 0; i < num_values; ++i) {
+		auto value = static_cast<double>(rng(1'000'000)) / static_cast<double>(1 + rng(1'000));
+
+		strings.push_back(std::format("{}", value));
+		suffixed.push_back(std::format("{:.3f}{}", value, "KMG%"[rng(4)]));
+	}
+
+	double sink = 0;
+
+	auto ns = time_per_call([&] {
+		for (const auto &s : strings) {
+			sink += cpparg::convert_to<double>(s).value_or(0);
+		}
+	});
+
+	report("convert_float", "convert_to<double>", num_values, ns);
+
+	ns = time_per_call([&] {
+		for (const auto &s : suffixed) {
+			sink += cpparg::convert_to<double, cpparg::KiloMultiplier::binary>(s).value_or(0);
+		}
+	});
+
+	report("convert_float", "convert_to<double>, KiloMultiplier::binary", num_values, ns);
+
+	ns = time_per_call([&] {
+		for (const auto &s : strings) {
+			sink += std::strtod(s.c_str(), nullptr);
+		}
+	});
+
+	report("convert_float", "std::strtod", num_values, ns);
+
+	if (sink == 42) {
+		std::println(stderr, "unlikely sum");
+	}
+}
+
+// Convert a list of numbers with convert_list, and by splitting into
+// strings first
+auto bench_convert_list() -> void {
+	constexpr std::size_t num_values = 10'000;
+
+	Lcg rng;
+
+	std::string list;
+
+	for (std::size_t i = 0; i < num_values; ++i) {
+		if (i != 0) {
+			list.push_back(',');
+		}
+
+		list += std::format("{}", rng(10'000'000));
+	}
+
+	std::vector<std::uint32_t> values;
+
+	auto ns = time_per_call([&] {
+		values.clear();
+
+		if (!cpparg::convert_list<std::uint32_t>(list, ',', values)) {
+			std::println(stderr, "error converting list");
+		}
+	});
+
+	report("convert_list", "convert_list<uint32_t>", num_values, ns);
+
+	ns = time_per_call([&] {
+		values.clear();
+
+		std::vector<std::string> elements;
+
+		std::string_view sv = list;
+
+		for (auto pos = sv.find(','); ; pos = sv.find(',')) {
+			elements.emplace_back(sv.substr(0, pos));
+
+			if (pos == std::string_view::npos) {
+				break;
+			}
+
+			sv.remove_prefix(pos + 1);
+		}
+
+		for (const auto &element : elements) {
+			values.push_back(cpparg::convert_to<std::uint32_t>(element).value_or(0));
+		}
+	});
+
+	report("convert_list", "split to strings, convert_to<uint32_t>", num_values, ns);
+}
+
+// Parse a large response file
+auto bench_response_file() -> void {
+	constexpr std::size_t num_args = 500'000;
+
+	auto parser = make_parser(10);
+
+	parser.allow_response_files();
+
+	auto path = std::filesystem::temp_directory_path() / "cpparg_bench_response_file";
+
+	{
+		std::ofstream file(path, std::ios::binary);
+
+		for (std::size_t i = 0; i < num_args; ++i) {
+			file << std::format("\"/some/path/to/input/file {}.txt\"\n", i);
+		}
+	}
+
+	auto arg = "@" + path.string();
+
+	std::array argv = { "app", arg.c_str() };
+
+	auto ns = time_per_call([&] {
+		check_result(parser.parse_argv<cpparg::ParseResult>(argv.size(), argv.data()));
+	});
+
+	report("response_file", "ParseResult", num_args, ns);
+
+	ns = time_per_call([&] {
+		check_result(parser.parse_argv<cpparg::ParseResultView>(argv.size(), argv.data()));
+	});
+
+	report("response_file", "ParseResultView", num_args, ns);
+
+	std::filesystem::remove(path);
+}
+
+// Merge a large generated config file
+auto bench_config_file() -> void {
+	constexpr std::size_t num_lines = 50'000;
+
+	auto parser = make_parser(200);
+
+	auto path = std::filesystem::temp_directory_path() / "cpparg_bench_config_file";
+
+	{
+		std::ofstream file(path, std::ios::binary);
+
+		Lcg rng;
+
+		for (std::size_t i = 0; i < num_lines; ++i) {
+			auto option = rng(200);
+
+			if (i % 10 == 0) {
+				file << "# comment\n";
+			}
+			else if (option % 2) {
+				file << std::format("option-{} = value-{}\n", option, i);
+			}
+			else {
+				file << std::format("--option-{}\n", option);
+			}
+		}
+	}
+
+	auto path_str = path.string();
+
+	auto ns = time_per_call([&] {
+		cpparg::ParseResult result;
+
+		check_result(parser.merge_config_file(result, path_str.c_str()));
+	});
+
+	report("config_file", "ParseResult", num_lines, ns);
+
+	ns = time_per_call([&] {
+		cpparg::ParseResultView result;
+
+		check_result(parser.merge_config_file(result, path_str.c_str()));
+	});
+
+	report("config_file", "ParseResultView", num_lines, ns);
+
+	std::filesystem::remove(path);
+}
+
+// Split command line strings into arguments, compared to splitting at
+// whitespace into strings with std::istringstream
+auto bench_split_command_line() -> void {
+	constexpr std::size_t num_lines = 1'000;
+
+	Lcg rng;
+
+	std::vector<std::string> command_lines;
+
+	std::size_t num_args = 0;
+
+	for (std::size_t i = 0; i < num_lines; ++i) {
+		std::string line = "/usr/bin/app";
+
+		for (std::size_t j = 0, n = 5 + rng(20); j < n; ++j, ++num_args) {
+			switch (rng(4)) {
+			case 0:
+				line += std::format(" --option-{}=value-{}", rng(100), rng(1000));
+				break;
+			case 1:
+				line += std::format(" '/some/path/with spaces/file {}.txt'", rng(1000));
+				break;
+			default:
+				line += std::format(" /some/path/to/input/file-{}.txt", rng(1000));
+				break;
+			}
+		}
+
+		command_lines.push_back(std::move(line));
+	}
+
+	std::array<std::byte, 16384> buffer;
+
+	auto ns = time_per_call([&] {
+		for (const auto &line : command_lines) {
+			std::pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size());
+
+			check_result(cpparg::split_command_line(line, &arena));
+		}
+	});
+
+	report("split", "split_command_line", num_args, ns);
+
+	ns = time_per_call([&] {
+		for (const auto &line : command_lines) {
+			std::istringstream stream(line);
+
+			std::vector<std::string> args;
+
+			for (std::string arg; stream >> arg; ) {
+				args.push_back(std::move(arg));
+			}
+		}
+	});
+
+	report("split", "istringstream to strings, no quoting", num_args, ns);
+}
+
+// Parse many command lines with 1 to N threads
+auto bench_parse_many() -> void {
+	std::size_t num_lines = settings.quick ? 20'000 : 200'000;
+
+	auto parser = make_parser(100);
+
+	Lcg rng;
+
+	std::vector<std::vector<std::string>> command_lines(num_lines);
+
+	for (auto &line : command_lines) {
+		for (std::size_t i = 0, num_args = 2 + rng(10); i < num_args; ++i) {
+			if (rng(2) == 0) {
+				line.push_back(std::format("--option-{}=value", rng(50) * 2 + 1));
+			}
+			else {
+				line.push_back(std::format("/some/path/file-{}", rng(1000)));
+			}
+		}
+	}
+
+	auto max_threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+	for (std::size_t num_threads = 1; ; num_threads = std::min(num_threads * 2, max_threads)) {
+		auto ns = time_per_call([&] {
+			auto results = parser.parse_many<cpparg::ParseResultView>(command_lines, num_threads);
+		});
+
+		report("parse_many", std::format("{} threads", num_threads), num_lines, ns);
+
+		if (num_threads == max_threads) {
+			break;
+		}
+	}
+}
+
+constexpr std::array benchmarks = {
+	std::pair{"parse", &bench_parse_grid},
+	std::pair{"short_clusters", &bench_short_clusters},
+	std::pair{"positional", &bench_positional_arguments},
+	std::pair{"arena", &bench_arena},
+	std::pair{"parse_into", &bench_parse_into},
+	std::pair{"query", &bench_queries},
+	std::pair{"bind", &bench_bind},
+	std::pair{"environment", &bench_environment},
+	std::pair{"subcommands", &bench_subcommands},
+	std::pair{"help", &bench_help},
+	std::pair{"word_wrap", &bench_word_wrap},
+	std::pair{"convert_to", &bench_convert},
+	std::pair{"convert_compare", &bench_convert_compare},
+	std::pair{"convert_float", &bench_convert_floating},
+	std::pair{"convert_list", &bench_convert_list},
+	std::pair{"response_file", &bench_response_file},
+	std::pair{"config_file", &bench_config_file},
+	std::pair{"split", &bench_split_command_line},
+	std::pair{"parse_many", &bench_parse_many}
+};
+
+} // namespace
+
+auto main(int argc, char *argv[]) -> int
+{
+	cpparg::OptionParser parser;
+
+	parser.add_option("h", "help",     "",         "print this help and exit")
+	      .add_option("f", "format",   "FORMAT",   "output format, one of 'text', 'csv' or 'json' (default 'text')")
+	      .add_option("t", "min-time", "MS",       "minimum time to run each measurement in milliseconds (default 200)")
+	      .add_option("q", "quick",    "",         "skip the largest sizes")
+	      .add_option("l", "list",     "",         "list benchmarks and exit");
+
+	auto result = parser.parse_argv(argc, argv);
+
+	if (!result) {
+		std::println(stderr, "cpparg_bench: {}", result.error().what);
+
+		return 1;
+	}
+
+	if (result->contains("help")) {
+		std::println(
+			"usage: cpparg_bench [options] [BENCHMARK]...\n"
+			"\n"
+			"Benchmarks for cpparg. Runs the benchmarks whose name contains\n"
+			"one of the BENCHMARK arguments, or all benchmarks.\n"
+			"\n"
+			"{}",
+			parser.get_option_help(78)
+		);
+
+		return 0;
+	}
+
+	if (result->contains("list")) {
+		for (auto [name, fn] : benchmarks) {
+			std::println("{}", name);
+		}
+
+		return 0;
+	}
+
+	if (auto format = result->get_last_argument_for_option("format")) {
+		if (*format == "text") {
+			settings.format = OutputFormat::text;
+		}
+		else if (*format == "csv") {
+			settings.format = OutputFormat::csv;
+		}
+		else if (*format == "json") {
+			settings.format = OutputFormat::json;
+		}
+		else {
+			std::println(stderr, "cpparg_bench: unknown format '{}'", *format);
+
+			return 1;
+		}
+	}
+
+	if (auto min_time = result->get_last_argument_for_option("min-time")) {
+		auto ms = cpparg::convert_to<unsigned int>(*min_time);
+
+		if (!ms) {
+			std::println(stderr, "cpparg_bench: invalid minimum time '{}'", *min_time);
+
+			return 1;
+		}
+
+		settings.min_time = std::chrono::milliseconds(*ms);
+	}
+
+	settings.quick = result->contains("quick");
+
+	for (const auto &filter : result->get_positional_arguments()) {
+		settings.filters.push_back(filter);
+	}
+
+	if (settings.format == OutputFormat::text) {
+		std::println("{:<16} {:<50} {:>10} {:>14} {:>10} {:>12}", "benchmark", "variant", "items", "ns/call", "ns/item", "allocs/call");
+	}
+
+	for (auto [name, fn] : benchmarks) {
+		if (selected(name)) {
+			fn();
+		}
+	}
+
+	print_measurements();
+}
@@ -24,9 +24,14 @@
 #include "cpparg.hpp"
 
 #include <array>
+#include <cmath>
 #include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <limits>
+#include <memory_resource>
 #include <sstream>
 #include <unordered_set>
 #include <vector>
@@ -125,6 +130,19 @@ TEST_CASE("double dash", "[cpparg]") {
 		REQUIRE(result->get_positional_arguments().size() == 0);
 	}
 
+	SECTION("string_view elements") {
+		std::array<std::string_view, 3> args = {
+			"-n", "--", "-n"
+		};
+
+		auto result = default_parser.parse(args.begin(), args.end());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->get_positional_arguments().size() == 1);
+		REQUIRE(result->get_positional_arguments().front() == "-n");
+	}
+
 	SECTION("as arg") {
 		std::array args = {
 			"app", "-r", "--", "-n"
@@ -475,6 +493,64 @@ TEST_CASE("reqarg next", "[cpparg]") {
 	}
 }
 
+TEST_CASE("short cluster", "[cpparg]") {
+	SECTION("noarg") {
+		std::array args = {
+			"app", "-nnnn"
+		};
+
+		auto result = default_parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->count("noarg") == 4);
+	}
+
+	SECTION("with argument") {
+		std::array args = {
+			"app", "-nnrxyz", "-no"
+		};
+
+		auto result = default_parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->count("noarg") == 3);
+		REQUIRE(result->get_last_argument_for_option("reqarg") == "xyz");
+		REQUIRE(result->count("optarg") == 1);
+	}
+
+	SECTION("unrecognized") {
+		std::array args = {
+			"app", "-n", "-nnu"
+		};
+
+		auto result = default_parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(!result.has_value());
+
+		REQUIRE(result.error().originating_arg == 2);
+	}
+
+	SECTION("non-ASCII flag") {
+		cpparg::OptionParser parser;
+
+		parser.add_option("\xE6", "ae", "", "")
+		      .add_option("\xE6", "duplicate", "", "");
+
+		std::array args = {
+			"app", "-\xE6\xE6"
+		};
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->count("ae") == 2);
+		REQUIRE(!result->contains("duplicate"));
+	}
+}
+
 TEST_CASE("alt argument syntax", "[cpparg]") {
 	cpparg::OptionParser parser;
 
@@ -521,178 +597,1925 @@ TEST_CASE("alt argument syntax", "[cpparg]") {
 	}
 }
 
-TEST_CASE("convert_to<signed>", "[cpparg]") {
-	SECTION("simple") {
-		REQUIRE(cpparg::convert_to<int>("42") == 42);
-		REQUIRE(cpparg::convert_to<int>("-42") == -42);
-	}
+TEST_CASE("many options", "[cpparg]") {
+	cpparg::OptionParser parser;
 
-	SECTION("base 16") {
-		REQUIRE(cpparg::convert_to<int>("0x20", 16) == 32);
-		REQUIRE(cpparg::convert_to<int>("20", 16) == 32);
-		REQUIRE(cpparg::convert_to<int>("-0x20", 16) == -32);
-		REQUIRE(cpparg::convert_to<int>("-20", 16) == -32);
+	for (int i = 0; i < 1000; ++i) {
+		parser.add_option("", std::format("option{}", i), i % 2 ? "ARG" : "", "");
 	}
 
-	SECTION("base 8") {
-		REQUIRE(cpparg::convert_to<int>("0644", 8) == 0b110'100'100);
-		REQUIRE(cpparg::convert_to<int>("644", 8) == 0b110'100'100);
-	}
+	// Duplicate long flag, first option added takes precedence
+	parser.add_option("", "option0", "ARG", "");
 
-	SECTION("base 2") {
-		REQUIRE(cpparg::convert_to<int>("0b1011", 2) == 0b1011);
-		REQUIRE(cpparg::convert_to<int>("1011", 2) == 0b1011);
+	std::array args = {
+		"app", "--option0", "--option999=arg", "--option500"
+	};
+
+	auto result = parser.parse_argv(args.size(), args.data());
+
+	REQUIRE(result.has_value());
+
+	REQUIRE(result->count("option0") == 1);
+	REQUIRE(result->get_last_argument_for_option("option999") == "arg");
+	REQUIRE(result->count("option500") == 1);
+
+	std::array bad_args = {
+		"app", "--option1000"
+	};
+
+	REQUIRE(!parser.parse_argv(bad_args.size(), bad_args.data()).has_value());
+}
+
+TEST_CASE("long option prefix", "[cpparg]") {
+	cpparg::OptionParser parser;
+
+	parser.add_option("", "verbose", "",    "")
+	      .add_option("", "version", "",    "")
+	      .add_option("", "value",   "ARG", "")
+	      .add_option("", "val",     "",    "");
+
+	SECTION("disabled") {
+		std::array args = {
+			"app", "--verb"
+		};
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(!result.has_value());
 	}
 
+	parser.allow_long_option_prefixes();
 
-	SECTION("base 0") {
-		REQUIRE(cpparg::convert_to<int>("0x20", 0) == 32);
-		REQUIRE(cpparg::convert_to<int>("-0x20", 0) == -32);
-		REQUIRE(cpparg::convert_to<int>("0644", 0) == 0b110'100'100);
-		REQUIRE(cpparg::convert_to<int>("0b1011", 0) == 0b1011);
+	SECTION("unambiguous") {
+		std::array args = {
+			"app", "--verb", "--vers", "--valu=arg"
+		};
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->get_parsed_options().size() == 3);
+		REQUIRE(result->get_parsed_options()[0].name == "verbose");
+		REQUIRE(result->get_parsed_options()[1].name == "version");
+		REQUIRE(result->get_parsed_options()[2].name == "value");
+		REQUIRE(result->get_last_argument_for_option("value") == "arg");
 	}
 
-	SECTION("limits") {
-		REQUIRE(cpparg::convert_to<std::int8_t>("127") == 127);
-		REQUIRE(!cpparg::convert_to<std::int8_t>("128"));
-		REQUIRE(cpparg::convert_to<std::int8_t>("-128") == -128);
-		REQUIRE(!cpparg::convert_to<std::int8_t>("-129"));
+	SECTION("exact match preferred") {
+		std::array args = {
+			"app", "--val"
+		};
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->contains("val"));
+		REQUIRE(!result->contains("value"));
 	}
 
-	SECTION("invalid") {
-		REQUIRE(!cpparg::convert_to<int>(""));
-		REQUIRE(!cpparg::convert_to<int>("20h"));
-		REQUIRE(!cpparg::convert_to<int>("42 "));
-		REQUIRE(!cpparg::convert_to<int>(" 42"));
-		REQUIRE(!cpparg::convert_to<int>("x20", 16));
-		REQUIRE(!cpparg::convert_to<int>("0102010", 2));
-		REQUIRE(!cpparg::convert_to<int>("0649", 8));
+	SECTION("ambiguous") {
+		std::array args = {
+			"app", "--ver"
+		};
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(!result.has_value());
+
+		REQUIRE(result.error().originating_arg == 1);
+		REQUIRE(result.error().what.find("'--verbose', '--version'") != std::string::npos);
 	}
 
-	SECTION("decimal suffix") {
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1k") == 1'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1K") == 1'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1m") == 1'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1M") == 1'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1g") == 1'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1G") == 1'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1t") == 1'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1T") == 1'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1p") == 1'000'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1P") == 1'000'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1e") == 1'000'000'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1E") == 1'000'000'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::decimal>("32k") == 32 * 1000);
-		REQUIRE(cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::decimal>("-32k") == -32 * 1000);
-		REQUIRE(!cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::decimal>("33k"));
-		REQUIRE(!cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::decimal>("-33k"));
+	SECTION("no match") {
+		std::array args = {
+			"app", "--verx"
+		};
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(!result.has_value());
+
+		REQUIRE(result.error().what.starts_with("unrecognized"));
 	}
 
-	SECTION("binary suffix") {
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1k") == 1LL << 10);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1K") == 1LL << 10);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1m") == 1LL << 20);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1M") == 1LL << 20);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1g") == 1LL << 30);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1G") == 1LL << 30);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1t") == 1LL << 40);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1T") == 1LL << 40);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1p") == 1LL << 50);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1P") == 1LL << 50);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1e") == 1LL << 60);
-		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1E") == 1LL << 60);
-		REQUIRE(cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::binary>("31k") == 31 * 1024);
-		REQUIRE(cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::binary>("-32k") == -32 * 1024);
-		REQUIRE(!cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::binary>("32k"));
-		REQUIRE(!cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::binary>("-33k"));
+	SECTION("option added after enabling") {
+		parser.add_option("", "verify", "", "");
+
+		std::array args = {
+			"app", "--veri", "--verb"
+		};
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->contains("verify"));
+		REQUIRE(result->contains("verbose"));
 	}
 }
 
-TEST_CASE("convert_to<unsigned>", "[cpparg]") {
-	SECTION("simple") {
-		REQUIRE(cpparg::convert_to<unsigned int>("42") == 42U);
-		REQUIRE(cpparg::convert_to<unsigned int>("-42") == -42U);
-	}
+TEST_CASE("ParseResultView", "[cpparg]") {
+	std::array args = {
+		"app", "-n", "--reqarg", "arg1", "-rarg2", "foo", "--", "-n"
+	};
 
-	SECTION("base 16") {
-		REQUIRE(cpparg::convert_to<unsigned int>("0x20", 16) == 32U);
-		REQUIRE(cpparg::convert_to<unsigned int>("20", 16) == 32U);
-		REQUIRE(cpparg::convert_to<unsigned int>("-0x20", 16) == -32U);
-		REQUIRE(cpparg::convert_to<unsigned int>("-20", 16) == -32U);
-	}
+	auto result = default_parser.parse_argv<cpparg::ParseResultView>(args.size(), args.data());
 
-	SECTION("base 8") {
-		REQUIRE(cpparg::convert_to<unsigned int>("0644", 8) == 0b110'100'100);
-		REQUIRE(cpparg::convert_to<unsigned int>("644", 8) == 0b110'100'100);
-	}
+	REQUIRE(result.has_value());
 
-	SECTION("base 2") {
-		REQUIRE(cpparg::convert_to<unsigned int>("0b1011", 2) == 0b1011);
-		REQUIRE(cpparg::convert_to<unsigned int>("1011", 2) == 0b1011);
-	}
+	REQUIRE(result->count("noarg") == 1);
 
+	REQUIRE(result->get_arguments_for_option("reqarg").size() == 2);
 
-	SECTION("base 0") {
-		REQUIRE(cpparg::convert_to<unsigned int>("0x20", 0) == 32U);
-		REQUIRE(cpparg::convert_to<unsigned int>("-0x20", 0) == -32U);
-		REQUIRE(cpparg::convert_to<unsigned int>("0644", 0) == 0b110'100'100);
-		REQUIRE(cpparg::convert_to<unsigned int>("0b1011", 0) == 0b1011);
-	}
+	// Arguments refer to the elements parsed
+	REQUIRE(result->get_arguments_for_option("reqarg").front().data() == args[3]);
+	REQUIRE(result->get_arguments_for_option("reqarg").back().data() == args[4] + 2);
 
-	SECTION("limits") {
-		REQUIRE(cpparg::convert_to<std::uint8_t>("255") == 255U);
-		REQUIRE(!cpparg::convert_to<std::uint8_t>("256"));
-		REQUIRE(cpparg::convert_to<std::uint8_t>("-1") == 255U);
-		REQUIRE(cpparg::convert_to<std::uint8_t>("-255") == 1U);
-		REQUIRE(!cpparg::convert_to<std::uint8_t>("-256"));
+	REQUIRE(result->get_last_argument_for_option("reqarg") == "arg2");
+
+	REQUIRE(result->get_positional_arguments().size() == 2);
+	REQUIRE(result->get_positional_arguments().front().data() == args[5]);
+	REQUIRE(result->get_positional_arguments().back() == "-n");
+
+	SECTION("range") {
+		std::vector<std::string> strings(args.begin() + 1, args.end());
+
+		auto view_result = default_parser.parse<cpparg::ParseResultView>(strings.begin(), strings.end());
+
+		REQUIRE(view_result.has_value());
+
+		REQUIRE(view_result->get_positional_arguments().front().data() == strings[4].data());
 	}
+}
 
-	SECTION("invalid") {
-		REQUIRE(!cpparg::convert_to<unsigned int>(""));
-		REQUIRE(!cpparg::convert_to<unsigned int>("20h"));
-		REQUIRE(!cpparg::convert_to<unsigned int>("42 "));
-		REQUIRE(!cpparg::convert_to<unsigned int>(" 42"));
-		REQUIRE(!cpparg::convert_to<unsigned int>("x20", 16));
-		REQUIRE(!cpparg::convert_to<unsigned int>("0102010", 2));
-		REQUIRE(!cpparg::convert_to<unsigned int>("0649", 8));
+// Views of elements of ranges yielding strings by value would dangle
+template<typename R>
+concept Parsable = requires(R &range) {
+	default_parser.parse<cpparg::ParseResultView>(range.begin(), range.end());
+};
+
+inline auto to_string_arg = [](int i) { return std::to_string(i); };
+inline auto to_view_arg = [](const std::string &s) { return std::string_view(s); };
+
+static_assert(Parsable<std::vector<std::string>>);
+static_assert(Parsable<std::array<const char *, 2>>);
+static_assert(Parsable<std::vector<std::string_view>>);
+static_assert(Parsable<std::ranges::transform_view<std::ranges::ref_view<std::vector<std::string>>, decltype(to_view_arg)>>);
+static_assert(!Parsable<std::ranges::transform_view<std::ranges::iota_view<int, int>, decltype(to_string_arg)>>);
+
+// Memory resource that counts allocations and bytes in use
+struct CountingResource : std::pmr::memory_resource {
+	std::size_t allocations = 0;
+	std::size_t bytes_in_use = 0;
+
+	auto do_allocate(std::size_t bytes, std::size_t alignment) -> void * override {
+		++allocations;
+		bytes_in_use += bytes;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
 	}
 
-	SECTION("decimal suffix") {
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1k") == 1'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1K") == 1'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1m") == 1'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1M") == 1'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1g") == 1'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1G") == 1'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1t") == 1'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1T") == 1'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1p") == 1'000'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1P") == 1'000'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1e") == 1'000'000'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1E") == 1'000'000'000'000'000'000LL);
-		REQUIRE(cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::decimal>("65k") == 65U * 1000);
-		REQUIRE(cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::decimal>("-65k") == static_cast<std::uint16_t>(-(65U * 1000)));
-		REQUIRE(!cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::decimal>("66k"));
+	auto do_deallocate(void *p, std::size_t bytes, std::size_t alignment) -> void override {
+		bytes_in_use -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
 	}
 
-	SECTION("binary suffix") {
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1k") == 1ULL << 10);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1K") == 1ULL << 10);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1m") == 1ULL << 20);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1M") == 1ULL << 20);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1g") == 1ULL << 30);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1G") == 1ULL << 30);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1t") == 1ULL << 40);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1T") == 1ULL << 40);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1p") == 1ULL << 50);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1P") == 1ULL << 50);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1e") == 1ULL << 60);
-		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1E") == 1ULL << 60);
-		REQUIRE(cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::binary>("63k") == 63U * 1024);
-		REQUIRE(cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::binary>("-63k") == static_cast<std::uint16_t>(-(63U * 1024)));
-		REQUIRE(!cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::binary>("64k"));
+	auto do_is_equal(const std::pmr::memory_resource &other) const noexcept -> bool override {
+		return this == &other;
 	}
-}
+};
+
+TEST_CASE("pmr", "[cpparg]") {
+	// Fail if the default resource is used
+	CountingResource parser_resource;
+	CountingResource result_resource;
+
+	auto *old_default = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+	{
+		cpparg::pmr::OptionParser parser(&parser_resource);
+
+		parser.add_option("n", "noarg",  "",      "option with no argument")
+		      .add_option("o", "optarg", "[ARG]", "option with optional argument")
+		      .add_option("r", "reqarg", "ARG",   "option with required argument that has a long description");
+
+		REQUIRE(parser_resource.allocations > 0);
+
+		std::array args = {
+			"app", "-n", "--reqarg", "a long argument that does not fit in a small string", "-oarg", "a long positional argument that does not fit in a small string"
+		};
+
+		auto result = parser.parse_argv<cpparg::pmr::ParseResult>(args.size(), args.data(), &result_resource);
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result_resource.allocations > 0);
+		REQUIRE(result->get_allocator().resource() == &result_resource);
+
+		REQUIRE(result->count("noarg") == 1);
+		REQUIRE(result->get_arguments_for_option("reqarg").front() == args[3]);
+		REQUIRE(result->get_arguments_for_option("optarg").front() == "arg");
+		REQUIRE(result->get_positional_arguments().front() == args[5]);
+
+		std::pmr::monotonic_buffer_resource arena(std::pmr::new_delete_resource());
+
+		auto view_result = parser.parse_argv<cpparg::pmr::ParseResultView>(args.size(), args.data(), &arena);
+
+		REQUIRE(view_result.has_value());
+
+		REQUIRE(view_result->get_positional_arguments().front().data() == args[5]);
+
+		CountingResource copy_resource;
+
+		cpparg::pmr::ParseResult copy(*result, &copy_resource);
+
+		REQUIRE(copy_resource.allocations > 0);
+		REQUIRE(copy.get_allocator().resource() == &copy_resource);
+		REQUIRE(copy.count("noarg") == 1);
+		REQUIRE(copy.get_arguments_for_option("reqarg").front() == args[3]);
+		REQUIRE(copy.get_arguments_for_option("optarg").front() == "arg");
+		REQUIRE(copy.get_positional_arguments().front() == args[5]);
+
+		std::vector<std::span<const char * const>> command_lines(10, std::span(args).subspan(1));
+
+		auto results = parser.parse_many<cpparg::pmr::ParseResult>(command_lines, 1, &result_resource);
+
+		REQUIRE(results.size() == 10);
+		REQUIRE(results.back().has_value());
+		REQUIRE(results.back()->get_allocator().resource() == &result_resource);
+		REQUIRE(results.back()->get_arguments_for_option("reqarg").front() == args[3]);
+	}
+
+	std::pmr::set_default_resource(old_default);
+}
+
+TEST_CASE("OptionId", "[cpparg]") {
+	cpparg::OptionParser parser;
+
+	auto noarg = parser.add_option_with_id("n", "noarg", "", "option with no argument");
+	auto optarg = parser.add_option_with_id("o", "optarg", "[ARG]", "option with optional argument");
+	auto reqarg = parser.add_option_with_id("r", "reqarg", "ARG", "option with required argument");
+
+	REQUIRE(parser.find_option_id("noarg") == noarg);
+	REQUIRE(parser.find_option_id("reqarg") == reqarg);
+	REQUIRE(!parser.find_option_id("unknown").has_value());
+
+	std::array args = {
+		"app", "-n", "--noarg", "-rarg1", "--reqarg", "arg2"
+	};
+
+	auto result = parser.parse_argv(args.size(), args.data());
+
+	REQUIRE(result.has_value());
+
+	REQUIRE(result->contains(noarg));
+	REQUIRE(result->count(noarg) == 2);
+	REQUIRE(result->get_arguments_for_option(noarg).empty());
+
+	REQUIRE(!result->contains(optarg));
+	REQUIRE(result->count(optarg) == 0);
+	REQUIRE(!result->get_last_argument_for_option(optarg).has_value());
+
+	REQUIRE(result->count(reqarg) == 2);
+	REQUIRE(result->get_arguments_for_option(reqarg).size() == 2);
+	REQUIRE(result->get_last_argument_for_option(reqarg) == "arg2");
+
+	// Queries by name give the same results
+	REQUIRE(result->count("noarg") == 2);
+	REQUIRE(result->get_parsed_options().size() == 2);
+
+	REQUIRE(!result->contains(cpparg::OptionId{}));
+}
+
+constexpr auto static_parser = cpparg::make_parser(
+	cpparg::opt<"n", "noarg",  "",      "option with no argument">(),
+	cpparg::opt<"o", "optarg", "[ARG]", "option with optional argument">(),
+	cpparg::opt<"r", "reqarg", "ARG",   "option with required argument">(),
+	cpparg::opt<"s", "",       "=ARG",  "short option with required argument">()
+);
+
+static_assert(static_parser.get_option_id("optarg") == cpparg::OptionId{1});
+static_assert(!static_parser.find_option_id("unknown").has_value());
+static_assert(static_parser.get_options()[1].arg_name == "[=ARG]");
+static_assert(static_parser.get_options()[2].arg_name == " ARG");
+static_assert(static_parser.get_options()[3].long_flag == "s");
+static_assert(static_parser.get_options()[3].arg_name == "ARG");
+
+// Names "aa" to "zz"
+constexpr auto static_many_names = [] {
+	std::array<char, 26 * 26 * 2> names{};
+
+	for (std::size_t i = 0; i < 26 * 26; ++i) {
+		names[2 * i] = static_cast<char>('a' + i / 26);
+		names[2 * i + 1] = static_cast<char>('a' + i % 26);
+	}
+
+	return names;
+}();
+
+constexpr auto static_many_parser = []() consteval {
+	std::array<cpparg::StaticOption, 26 * 26> options{};
+
+	for (std::size_t i = 0; i < options.size(); ++i) {
+		options[i].long_flag = std::string_view(static_many_names.data() + 2 * i, 2);
+	}
+
+	return cpparg::StaticOptionParser(options);
+}();
+
+static_assert(static_many_parser.get_option_id("aa") == cpparg::OptionId{0});
+static_assert(static_many_parser.get_option_id("mq") == cpparg::OptionId{12 * 26 + 16});
+static_assert(static_many_parser.get_option_id("zz") == cpparg::OptionId{26 * 26 - 1});
+static_assert(!static_many_parser.find_option_id("a").has_value());
+static_assert(!static_many_parser.find_option_id("aaa").has_value());
+
+TEST_CASE("StaticOptionParser", "[cpparg]") {
+	SECTION("parse") {
+		std::array args = {
+			"app", "-n", "--optarg=arg1", "-rarg2", "--reqarg", "arg3", "-sarg4", "foo", "--", "-n"
+		};
+
+		auto result = static_parser.parse_argv<cpparg::ParseResultView>(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->count("noarg") == 1);
+		REQUIRE(result->get_last_argument_for_option("optarg") == "arg1");
+		REQUIRE(result->get_arguments_for_option(static_parser.get_option_id("reqarg")).size() == 2);
+		REQUIRE(result->get_last_argument_for_option("s") == "arg4");
+
+		REQUIRE(result->get_positional_arguments().size() == 2);
+	}
+
+	SECTION("errors") {
+		std::array unknown_long = {
+			"app", "--unknown"
+		};
+
+		REQUIRE(!static_parser.parse_argv(unknown_long.size(), unknown_long.data()).has_value());
+
+		std::array unknown_short = {
+			"app", "-nu"
+		};
+
+		REQUIRE(!static_parser.parse_argv(unknown_short.size(), unknown_short.data()).has_value());
+
+		std::array missing = {
+			"app", "--reqarg"
+		};
+
+		REQUIRE(!static_parser.parse_argv(missing.size(), missing.data()).has_value());
+	}
+
+	SECTION("many options") {
+		std::array args = {
+			"--aa", "--mq", "--zz", "--zz"
+		};
+
+		auto result = static_many_parser.parse(args.begin(), args.end());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->count("aa") == 1);
+		REQUIRE(result->count("mq") == 1);
+		REQUIRE(result->count("zz") == 2);
+
+		std::array bad_args = {
+			"--ab0"
+		};
+
+		REQUIRE(!static_many_parser.parse(bad_args.begin(), bad_args.end()).has_value());
+	}
+}
+
+TEST_CASE("option help", "[cpparg]") {
+	cpparg::OptionParser parser;
+
+	parser.add_option("h", "help",      "",       "print this help and exit")
+	      .add_option("r", "required",  "ARG",    "option with required argument")
+	      .add_option("o", "optional",  "[ARG]",  "option with optional argument")
+	      .add_option("",  "long-only", "=VALUE", "long option with a description that needs wrapping")
+	      .add_option("s", "",          "N",      "short only")
+	      .add_option("x", "",          "[=N]",   "short only optional")
+	      .add_option("",  "a-really-long-option-name", "[=SOMETHING]", "description on next line\n")
+	      .add_option("q", "quiet",     "",       "")
+	      .add_option("z", "zzz",       "",       "[hidden] not shown");
+
+	SECTION("no wrap") {
+		REQUIRE(parser.get_option_help() ==
+			"  -h, --help                 print this help and exit\n"
+			"  -r, --required ARG         option with required argument\n"
+			"  -o, --optional[=ARG]       option with optional argument\n"
+			"      --long-only=VALUE      long option with a description that needs wrapping\n"
+			"  -s N                       short only\n"
+			"  -x[N]                      short only optional\n"
+			"      --a-really-long-option-name[=SOMETHING]\n"
+			"                             description on next line\n"
+			"\n"
+			"  -q, --quiet\n"
+		);
+	}
+
+	SECTION("wrap") {
+		REQUIRE(parser.get_option_help(50) ==
+			"  -h, --help                 print this help and\n"
+			"                             exit\n"
+			"  -r, --required ARG         option with required\n"
+			"                             argument\n"
+			"  -o, --optional[=ARG]       option with optional\n"
+			"                             argument\n"
+			"      --long-only=VALUE      long option with a\n"
+			"                             description that\n"
+			"                             needs wrapping\n"
+			"  -s N                       short only\n"
+			"  -x[N]                      short only optional\n"
+			"      --a-really-long-option-name[=SOMETHING]\n"
+			"                             description on next\n"
+			"                             line\n"
+			"\n"
+			"  -q, --quiet\n"
+		);
+	}
+
+	SECTION("output iterator") {
+		std::array<char, 2048> buffer{};
+
+		auto end = parser.format_option_help_to(buffer.data(), 50);
+
+		REQUIRE(std::string_view(buffer.data(), end) == parser.get_option_help(50));
+
+		std::ostringstream stream;
+
+		parser.format_option_help_to(std::ostreambuf_iterator<char>(stream));
+
+		REQUIRE(stream.str() == parser.get_option_help());
+	}
+
+	SECTION("FILE") {
+		// Repeat options to exceed the buffer size
+		for (int i = 0; i < 100; ++i) {
+			parser.add_option("", std::format("option-{}", i), "ARG", "an option with a description");
+		}
+
+		std::FILE *f = std::tmpfile();
+
+		REQUIRE(f != nullptr);
+
+		REQUIRE(parser.format_option_help_to(f, 60));
+
+		std::rewind(f);
+
+		std::string contents;
+
+		for (int c; (c = std::fgetc(f)) != EOF; ) {
+			contents.push_back(static_cast<char>(c));
+		}
+
+		std::fclose(f);
+
+		REQUIRE(contents.size() > 4096);
+		REQUIRE(contents == parser.get_option_help(60));
+	}
+
+	SECTION("FILE writer iterator") {
+		std::FILE *f = std::tmpfile();
+
+		REQUIRE(f != nullptr);
+
+		std::string expected;
+
+		{
+			cpparg::detail::FileWriter writer(f);
+
+			auto it = writer.begin();
+
+			// Postfix increment returns a copy that is written through
+			for (int i = 0; i < 5000; ++i) {
+				char c = static_cast<char>('a' + i % 26);
+
+				*it++ = c;
+				expected.push_back(c);
+			}
+
+			it = std::ranges::copy(std::string_view("end"), it).out;
+			expected += "end";
+
+			REQUIRE(writer.flush());
+		}
+
+		std::rewind(f);
+
+		std::string contents;
+
+		for (int c; (c = std::fgetc(f)) != EOF; ) {
+			contents.push_back(static_cast<char>(c));
+		}
+
+		std::fclose(f);
+
+		REQUIRE(contents == expected);
+	}
+}
+
+constexpr auto static_help_parser = cpparg::make_parser(
+	cpparg::opt<"h", "help",      "",       "print this help and exit">(),
+	cpparg::opt<"r", "required",  "ARG",    "option with required argument">(),
+	cpparg::opt<"o", "optional",  "[ARG]",  "option with optional argument">(),
+	cpparg::opt<"",  "long-only", "=VALUE", "long option with a description that needs wrapping">(),
+	cpparg::opt<"s", "",          "N",      "short only">()
+);
+
+static_assert(cpparg::static_option_help<static_help_parser>.starts_with("  -h, --help "));
+
+TEST_CASE("word_wrap", "[cpparg]") {
+	auto lines = [](std::string_view sv, std::size_t width) {
+		std::vector<std::string_view> res;
+
+		for (auto line : cpparg::word_wrap(sv, width)) {
+			res.push_back(line);
+		}
+
+		return res;
+	};
+
+	using lines_type = std::vector<std::string_view>;
+
+	SECTION("short text") {
+		REQUIRE(lines("", 10) == lines_type{""});
+		REQUIRE(lines("   ", 10) == lines_type{});
+		REQUIRE(lines("one two three", 20) == lines_type{"one two three"});
+		REQUIRE(lines("  one two three", 7) == lines_type{"one two", "three"});
+		REQUIRE(lines("one  two   three ", 3) == lines_type{"one", "two", "three"});
+		REQUIRE(lines("unbreakable-word x", 5) == lines_type{"unbreakable-word", "x"});
+	}
+
+	SECTION("long text") {
+		std::string text;
+
+		for (int i = 0; i < 500; ++i) {
+			text.append(i % 7 ? "word " : "a-much-longer-word    ");
+		}
+
+		auto wrapped = lines(text, 72);
+
+		REQUIRE(wrapped.size() > 1);
+
+		std::size_t num_chars = 0;
+
+		for (auto line : wrapped) {
+			REQUIRE((line.size() <= 72 || !line.contains(' ')));
+			REQUIRE(!line.starts_with(' '));
+
+			num_chars += std::ranges::count_if(line, [](char ch) { return ch != ' '; });
+		}
+
+		REQUIRE(num_chars == static_cast<std::size_t>(std::ranges::count_if(text, [](char ch) { return ch != ' '; })));
+	}
+
+	SECTION("lazy view") {
+		std::string_view text = "first line of a text which is long";
+
+		auto wrapped = cpparg::word_wrap(text, 10);
+
+		REQUIRE(*wrapped.begin() == "first line");
+		REQUIRE((*wrapped.begin()).data() == text.data());
+		REQUIRE(wrapped.front() == "first line");
+
+		auto it = std::ranges::next(wrapped.begin(), 2);
+
+		REQUIRE(*it == "which is");
+		REQUIRE(std::ranges::distance(wrapped) == 4);
+		REQUIRE(std::ranges::distance(wrapped | std::views::take(2)) == 2);
+	}
+}
+
+TEST_CASE("static option help", "[cpparg]") {
+	cpparg::OptionParser parser;
+
+	parser.add_option("h", "help",      "",       "print this help and exit")
+	      .add_option("r", "required",  "ARG",    "option with required argument")
+	      .add_option("o", "optional",  "[ARG]",  "option with optional argument")
+	      .add_option("",  "long-only", "=VALUE", "long option with a description that needs wrapping")
+	      .add_option("s", "",          "N",      "short only");
+
+	REQUIRE(cpparg::static_option_help<static_help_parser> == parser.get_option_help());
+	REQUIRE(cpparg::static_option_help<static_help_parser, 50> == parser.get_option_help(50));
+	REQUIRE(static_help_parser.get_option_help(60) == parser.get_option_help(60));
+
+	std::string help;
+
+	static_help_parser.format_option_help_to(std::back_inserter(help), 60);
+
+	REQUIRE(help == parser.get_option_help(60));
+}
+
+TEST_CASE("events", "[cpparg]") {
+	std::array args = {
+		"foo", "-nrarg1", "--optarg=arg2", "bar", "--reqarg", "arg3", "-on", "--", "-n"
+	};
+
+	std::vector<cpparg::ParseEvent> events;
+
+	for (const auto &event : default_parser.events(args.begin(), args.end())) {
+		REQUIRE(event.has_value());
+
+		events.push_back(*event);
+	}
+
+	REQUIRE(events.size() == 8);
+
+	auto noarg_id = default_parser.find_option_id("noarg");
+	auto optarg_id = default_parser.find_option_id("optarg");
+	auto reqarg_id = default_parser.find_option_id("reqarg");
+
+	// Events are in the order they appear
+	REQUIRE(events[0].kind == cpparg::ParseEventKind::positional);
+	REQUIRE(events[0].argument == "foo");
+	REQUIRE(events[0].argv_index == 0);
+
+	REQUIRE(events[1].kind == cpparg::ParseEventKind::option);
+	REQUIRE(events[1].option_id == noarg_id);
+	REQUIRE(events[1].name == "noarg");
+	REQUIRE(!events[1].argument.has_value());
+	REQUIRE(events[1].argv_index == 1);
+
+	REQUIRE(events[2].option_id == reqarg_id);
+	REQUIRE(events[2].argument == "arg1");
+	REQUIRE(events[2].argv_index == 1);
+
+	REQUIRE(events[3].option_id == optarg_id);
+	REQUIRE(events[3].argument == "arg2");
+	REQUIRE(events[3].argv_index == 2);
+
+	REQUIRE(events[4].kind == cpparg::ParseEventKind::positional);
+	REQUIRE(events[4].argument == "bar");
+	REQUIRE(events[4].argv_index == 3);
+
+	REQUIRE(events[5].option_id == reqarg_id);
+	REQUIRE(events[5].argument == "arg3");
+	REQUIRE(events[5].argv_index == 4);
+
+	// Optional argument taken from rest of cluster
+	REQUIRE(events[6].option_id == optarg_id);
+	REQUIRE(events[6].argument == "n");
+	REQUIRE(events[6].argv_index == 6);
+
+	REQUIRE(events[7].kind == cpparg::ParseEventKind::positional);
+	REQUIRE(events[7].argument == "-n");
+	REQUIRE(events[7].argv_index == 8);
+
+	// Arguments refer to the elements parsed
+	REQUIRE(events[5].argument->data() == args[5]);
+
+	SECTION("error ends range") {
+		std::array error_args = { "-n", "--unknown", "-n" };
+
+		std::size_t count = 0;
+
+		for (const auto &event : default_parser.events(error_args.begin(), error_args.end())) {
+			if (++count == 2) {
+				REQUIRE(!event.has_value());
+				REQUIRE(event.error().originating_arg == 1);
+			}
+		}
+
+		REQUIRE(count == 2);
+	}
+
+	SECTION("static parser") {
+		std::array static_args = { "-n", "--reqarg", "x" };
+
+		auto range = static_parser.events(static_args.begin(), static_args.end());
+
+		auto it = range.begin();
+
+		REQUIRE(it != range.end());
+		REQUIRE((*it)->name == "noarg");
+
+		++it;
+
+		REQUIRE((*it)->name == "reqarg");
+		REQUIRE((*it)->argument == "x");
+		REQUIRE((*it)->argv_index == 1);
+
+		++it;
+
+		REQUIRE(it == range.end());
+	}
+}
+
+TEST_CASE("parse_with", "[cpparg]") {
+	std::array args = {
+		"-n", "foo", "--reqarg=arg1", "-n", "bar"
+	};
+
+	int noarg_count = 0;
+	std::string_view reqarg;
+	std::vector<std::string_view> positionals;
+
+	auto result = default_parser.parse_with(args.begin(), args.end(), [&](const cpparg::ParseEvent &event) {
+		if (event.kind == cpparg::ParseEventKind::positional) {
+			positionals.push_back(*event.argument);
+		}
+		else if (event.name == "noarg") {
+			++noarg_count;
+		}
+		else if (event.name == "reqarg") {
+			reqarg = *event.argument;
+		}
+	});
+
+	REQUIRE(result.has_value());
+	REQUIRE(*result == args.end());
+
+	REQUIRE(noarg_count == 2);
+	REQUIRE(reqarg == "arg1");
+	REQUIRE(positionals.size() == 2);
+	REQUIRE(positionals.front().data() == args[1]);
+
+	SECTION("stop") {
+		std::size_t count = 0;
+
+		auto stop_result = default_parser.parse_with(args.begin(), args.end(), [&](const cpparg::ParseEvent &event) {
+			++count;
+
+			return event.kind == cpparg::ParseEventKind::positional ? cpparg::ParseControl::stop
+			                                                        : cpparg::ParseControl::proceed;
+		});
+
+		REQUIRE(stop_result.has_value());
+		REQUIRE(count == 2);
+
+		// Returns position after stopping, so parsing can be resumed
+		REQUIRE(*stop_result == args.begin() + 2);
+	}
+
+	SECTION("error") {
+		std::array error_args = { "-n", "-x" };
+
+		std::size_t count = 0;
+
+		auto error_result = default_parser.parse_with(error_args.begin(), error_args.end(), [&](const cpparg::ParseEvent &) {
+			++count;
+		});
+
+		REQUIRE(!error_result.has_value());
+		REQUIRE(error_result.error().originating_arg == 1);
+		REQUIRE(count == 1);
+	}
+}
+
+#if defined(__cpp_lib_generator)
+TEST_CASE("parse_lazily", "[cpparg]") {
+	std::array args = {
+		"-n", "foo", "--reqarg", "arg1", "--unknown", "bar"
+	};
+
+	std::vector<std::expected<cpparg::ParseEvent, cpparg::ParseError>> items;
+
+	for (auto &&item : default_parser.parse_lazily(args.begin(), args.end())) {
+		items.push_back(std::move(item));
+	}
+
+	REQUIRE(items.size() == 4);
+
+	REQUIRE(items[0]->name == "noarg");
+	REQUIRE(items[1]->argument == "foo");
+	REQUIRE(items[2]->argument == "arg1");
+	REQUIRE(items[2]->argv_index == 2);
+
+	// Error is yielded where it occurs
+	REQUIRE(!items[3].has_value());
+	REQUIRE(items[3].error().originating_arg == 4);
+
+	SECTION("stop consuming") {
+		std::size_t count = 0;
+
+		for (auto &&item : default_parser.parse_lazily(args.begin(), args.end())) {
+			REQUIRE(item.has_value());
+
+			if (++count == 2) {
+				break;
+			}
+		}
+
+		REQUIRE(count == 2);
+	}
+}
+#endif
+
+TEST_CASE("response files", "[cpparg]") {
+	auto dir = std::filesystem::temp_directory_path() / "cpparg_test_response_files";
+
+	std::filesystem::create_directories(dir);
+
+	auto write_file = [&](const char *name, std::string_view contents) {
+		auto path = dir / name;
+
+		std::ofstream(path, std::ios::binary) << contents;
+
+		return "@" + path.string();
+	};
+
+	auto nested = write_file("nested", "--reqarg x\n");
+	auto quoted = write_file("quoted", "-n \"quoted arg\"\t'single q'\nback\\ slash \"\" " + nested + "\n");
+	auto nul = write_file("nul", std::string_view("-n\0two words\0", 13));
+	auto error = write_file("error", "-n --unknown");
+	auto self = write_file("self", "-n " + (dir / "self").string().insert(0, "@"));
+	auto missing = "@" + (dir / "missing").string();
+
+	auto parser = default_parser;
+
+	parser.allow_response_files();
+
+	SECTION("quoting") {
+		std::array args = { "app", "foo", quoted.c_str(), "bar" };
+
+		auto result = parser.parse_argv<cpparg::ParseResultView>(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->count("noarg") == 1);
+		REQUIRE(result->get_last_argument_for_option("reqarg") == "x");
+
+		auto positional = result->get_positional_arguments();
+
+		REQUIRE(positional.size() == 6);
+		REQUIRE(positional[0] == "foo");
+		REQUIRE(positional[1] == "quoted arg");
+		REQUIRE(positional[2] == "single q");
+		REQUIRE(positional[3] == "back slash");
+		REQUIRE(positional[4] == "");
+		REQUIRE(positional[5] == "bar");
+	}
+
+	SECTION("nul separated") {
+		std::array args = { "app", nul.c_str() };
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->count("noarg") == 1);
+		REQUIRE(result->get_positional_arguments().size() == 1);
+		REQUIRE(result->get_positional_arguments().front() == "two words");
+	}
+
+	SECTION("missing file") {
+		std::array args = { "app", missing.c_str(), "@" };
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->get_positional_arguments().size() == 2);
+		REQUIRE(result->get_positional_arguments().front() == missing);
+	}
+
+	SECTION("error in file") {
+		std::array args = { "app", "-n", error.c_str() };
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 2);
+	}
+
+	SECTION("recursive file") {
+		std::array args = { "app", self.c_str() };
+
+		auto result = parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 1);
+	}
+
+	SECTION("disabled") {
+		std::array args = { "app", nested.c_str() };
+
+		auto result = default_parser.parse_argv(args.size(), args.data());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(result->get_positional_arguments().front() == nested);
+	}
+
+	std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("parse_many", "[cpparg]") {
+	std::vector<std::vector<std::string>> command_lines;
+
+	for (std::size_t i = 0; i < 1000; ++i) {
+		if (i % 7 == 3) {
+			command_lines.push_back({"-n", "--unknown"});
+		}
+		else {
+			command_lines.push_back({"-r", std::to_string(i), "file"});
+		}
+	}
+
+	auto check_results = [&](const auto &results) {
+		REQUIRE(results.size() == command_lines.size());
+
+		for (std::size_t i = 0; i < results.size(); ++i) {
+			if (i % 7 == 3) {
+				REQUIRE(!results[i].has_value());
+				REQUIRE(results[i].error().originating_arg == 1);
+			}
+			else {
+				REQUIRE(results[i].has_value());
+				REQUIRE(results[i]->get_last_argument_for_option("reqarg") == std::to_string(i));
+			}
+		}
+	};
+
+	SECTION("one thread") {
+		check_results(default_parser.parse_many(command_lines, 1));
+	}
+
+	SECTION("four threads") {
+		check_results(default_parser.parse_many(command_lines, 4));
+	}
+
+	SECTION("argv spans") {
+		std::array args = { "app", "-n", "foo" };
+
+		std::vector<std::span<const char * const>> spans(100, std::span(args).subspan(1));
+
+		auto results = static_parser.parse_many<cpparg::ParseResultView>(spans);
+
+		REQUIRE(results.size() == 100);
+		REQUIRE(results.back().has_value());
+		REQUIRE(results.back()->get_positional_arguments().front().data() == args[2]);
+	}
+}
+
+TEST_CASE("parse_into", "[cpparg]") {
+	std::array args = {
+		"-n", "--reqarg", "arg1", "foo", "-rarg2"
+	};
+
+	cpparg::ParseResult result;
+
+	REQUIRE(default_parser.parse_into(result, args.begin(), args.end()).has_value());
+
+	REQUIRE(result.count("noarg") == 1);
+	REQUIRE(result.get_arguments_for_option("reqarg").size() == 2);
+	REQUIRE(result.get_positional_arguments().size() == 1);
+
+	SECTION("clears result") {
+		std::array other_args = { "--optarg", "bar" };
+
+		REQUIRE(default_parser.parse_into(result, other_args.begin(), other_args.end()).has_value());
+
+		REQUIRE(!result.contains("noarg"));
+		REQUIRE(!result.contains(*default_parser.find_option_id("reqarg")));
+		REQUIRE(result.get_arguments_for_option("reqarg").empty());
+		REQUIRE(result.count("optarg") == 1);
+		REQUIRE(result.contains(*default_parser.find_option_id("optarg")));
+		REQUIRE(result.get_parsed_options().size() == 1);
+		REQUIRE(result.get_parsed_options().front().name == "optarg");
+		REQUIRE(result.get_parsed_options().front().count == 1);
+		REQUIRE(result.get_positional_arguments().size() == 1);
+		REQUIRE(result.get_positional_arguments().front() == "bar");
+	}
+
+	SECTION("error") {
+		std::array error_args = { "-n", "-x" };
+
+		auto parsed = default_parser.parse_into(result, error_args.begin(), error_args.end());
+
+		REQUIRE(!parsed.has_value());
+		REQUIRE(parsed.error().originating_arg == 1);
+	}
+
+	SECTION("no allocations after warm up") {
+		CountingResource resource;
+
+		cpparg::pmr::ParseResultView view_result(&resource);
+
+		// Warm up, the first clear allocates storage for spare options
+		for (int i = 0; i < 2; ++i) {
+			REQUIRE(default_parser.parse_into(view_result, args.begin(), args.end()).has_value());
+		}
+
+		auto allocations = resource.allocations;
+
+		REQUIRE(allocations > 0);
+
+		for (int i = 0; i < 10; ++i) {
+			REQUIRE(default_parser.parse_into(view_result, args.begin(), args.end()).has_value());
+		}
+
+		REQUIRE(resource.allocations == allocations);
+
+		REQUIRE(view_result.count("noarg") == 1);
+		REQUIRE(view_result.get_last_argument_for_option("reqarg") == "arg2");
+	}
+
+	SECTION("positional arguments after double dash") {
+		std::vector<std::string> many_args = { "--" };
+
+		for (int i = 0; i < 100; ++i) {
+			many_args.push_back(std::format("-{}", i));
+		}
+
+		CountingResource resource;
+
+		cpparg::pmr::ParseResultView view_result(&resource);
+
+		REQUIRE(default_parser.parse_into(view_result, many_args.begin(), many_args.end()).has_value());
+
+		REQUIRE(view_result.get_positional_arguments().size() == 100);
+		REQUIRE(view_result.get_positional_arguments().front() == "-0");
+		REQUIRE(view_result.get_positional_arguments().back() == "-99");
+
+		// Arguments are added at once, instead of growing the vector
+		REQUIRE(resource.allocations < 5);
+	}
+
+	SECTION("view result outlives parser") {
+		cpparg::ParseResultView view_result;
+
+		std::array first_args = { "--first-option-with-a-long-name", "--shared-option-with-a-long-name" };
+
+		{
+			cpparg::OptionParser first_parser;
+
+			first_parser.add_option("", "first-option-with-a-long-name", "", "first")
+			            .add_option("", "shared-option-with-a-long-name", "", "shared");
+
+			REQUIRE(first_parser.parse_into(view_result, first_args.begin(), first_args.end()).has_value());
+		}
+
+		std::array second_args = { "--shared-option-with-a-long-name", "--second-option-with-a-long-name" };
+
+		cpparg::OptionParser second_parser;
+
+		second_parser.add_option("", "second-option-with-a-long-name", "", "second")
+		             .add_option("", "shared-option-with-a-long-name", "", "shared");
+
+		REQUIRE(second_parser.parse_into(view_result, second_args.begin(), second_args.end()).has_value());
+
+		REQUIRE(!view_result.contains("first-option-with-a-long-name"));
+		REQUIRE(view_result.count("shared-option-with-a-long-name") == 1);
+		REQUIRE(view_result.count("second-option-with-a-long-name") == 1);
+		REQUIRE(view_result.get_parsed_options().front().name == "shared-option-with-a-long-name");
+	}
+}
+
+TEST_CASE("bind", "[cpparg]") {
+	int threads = 1;
+	double ratio = 0.5;
+	bool verbose = false;
+	bool color = true;
+	std::string output = "a.out";
+	std::string_view mode;
+
+	cpparg::OptionParser parser;
+
+	parser.add_option("j", "threads", "N", "number of threads").bind(threads)
+	      .add_option("r", "ratio", "=RATIO", "ratio").bind(ratio)
+	      .add_option("v", "verbose", "", "be verbose").bind(verbose)
+	      .add_option("", "color", "[=WHEN]", "use color").bind(color)
+	      .add_option("o", "output", "FILE", "output file").bind(output)
+	      .add_option("m", "mode", "MODE", "mode").bind(mode)
+	      .add_option("n", "", "", "not bound");
+
+	SECTION("not present") {
+		std::array args = { "-n", "foo" };
+
+		REQUIRE(parser.parse(args.begin(), args.end()).has_value());
+
+		REQUIRE(threads == 1);
+		REQUIRE(ratio == 0.5);
+		REQUIRE(!verbose);
+		REQUIRE(color);
+		REQUIRE(output == "a.out");
+		REQUIRE(mode.empty());
+	}
+
+	SECTION("converted") {
+		std::array args = {
+			"-j", "4", "--ratio=0.25", "-vofoo", "--color=no", "--mode", "fast"
+		};
+
+		auto result = parser.parse<cpparg::ParseResultView>(args.begin(), args.end());
+
+		REQUIRE(result.has_value());
+
+		REQUIRE(threads == 4);
+		REQUIRE(ratio == 0.25);
+		REQUIRE(verbose);
+		REQUIRE(!color);
+		REQUIRE(output == "foo");
+		REQUIRE(mode == "fast");
+		REQUIRE(mode.data() == args[6]);
+
+		// Bound options are also in result
+		REQUIRE(result->get_last_argument_for_option("threads") == "4");
+		REQUIRE(result->count("verbose") == 1);
+	}
+
+	SECTION("last occurrence wins") {
+		std::array args = { "-j2", "--threads=8", "--color" };
+
+		color = false;
+
+		REQUIRE(parser.parse(args.begin(), args.end()).has_value());
+
+		REQUIRE(threads == 8);
+		REQUIRE(color);
+	}
+
+	SECTION("invalid argument") {
+		std::array args = { "-n", "--threads", "four" };
+
+		auto result = parser.parse(args.begin(), args.end());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 2);
+		REQUIRE(result.error().what.contains("four"));
+		REQUIRE(threads == 1);
+	}
+
+	SECTION("argument out of range") {
+		std::array args = { "-vj99999999999" };
+
+		auto result = parser.parse(args.begin(), args.end());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 0);
+		REQUIRE(result.error().what.contains("out of range"));
+		REQUIRE(!verbose);
+	}
+
+	SECTION("unchanged on error") {
+		std::array args = { "-j", "3", "-v", "--output=out", "--mode=fast", "--unknown" };
+
+		auto result = parser.parse<cpparg::ParseResultView>(args.begin(), args.end());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 5);
+		REQUIRE(threads == 1);
+		REQUIRE(!verbose);
+		REQUIRE(output == "a.out");
+		REQUIRE(mode.empty());
+
+		std::array bound_error_args = { "-v", "--ratio=0.25", "-j", "four" };
+
+		result = parser.parse<cpparg::ParseResultView>(bound_error_args.begin(), bound_error_args.end());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(!verbose);
+		REQUIRE(ratio == 0.5);
+	}
+
+	SECTION("many occurrences") {
+		std::vector<std::string> args;
+
+		for (int i = 0; i < 40; ++i) {
+			args.push_back(std::format("-vj{}", i));
+		}
+
+		REQUIRE(parser.parse(args.begin(), args.end()).has_value());
+		REQUIRE(threads == 39);
+		REQUIRE(verbose);
+
+		threads = 1;
+		verbose = false;
+
+		args.push_back("--unknown");
+
+		REQUIRE(!parser.parse(args.begin(), args.end()).has_value());
+		REQUIRE(threads == 1);
+		REQUIRE(!verbose);
+	}
+
+	SECTION("set after double dash and in clusters") {
+		std::array args = { "-nvj5", "--", "-j6" };
+
+		REQUIRE(parser.parse(args.begin(), args.end()).has_value());
+
+		REQUIRE(verbose);
+		REQUIRE(threads == 5);
+	}
+
+	SECTION("parse_argv") {
+		std::array argv = { "app", "--ratio=x" };
+
+		auto result = parser.parse_argv(argv.size(), argv.data());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 1);
+	}
+
+	SECTION("parse_many does not bind") {
+		std::vector<std::vector<std::string>> command_lines = {
+			{ "-j", "16" }, { "--threads=x" }
+		};
+
+		auto results = parser.parse_many(command_lines, 1);
+
+		REQUIRE(results.size() == 2);
+		REQUIRE(results[0].has_value());
+		REQUIRE(results[1].has_value());
+		REQUIRE(threads == 1);
+	}
+
+	SECTION("copy of parser") {
+		std::array args = { "-j", "3" };
+
+		auto copy = parser;
+
+		REQUIRE(copy.parse(args.begin(), args.end()).has_value());
+
+		REQUIRE(threads == 3);
+	}
+}
+
+TEST_CASE("environment", "[cpparg]") {
+	int threads = 1;
+
+	cpparg::OptionParser parser;
+
+	parser.add_option("j", "threads", "N", "number of threads").bind(threads)
+	      .add_option("", "dry-run", "", "do nothing")
+	      .add_option("", "color", "[=WHEN]", "use color")
+	      .add_option("o", "output", "FILE", "output file");
+
+	parser.set_env_prefix("APP");
+
+	std::array envp = {
+		"HOME=/home/user",
+		"APP_THREADS=4",
+		"APP_DRY_RUN=yes",
+		"APP_OUTPUT=out.txt",
+		"APP_UNKNOWN=1",
+		"APPLE=1",
+		"OTHER_COLOR=always",
+		static_cast<const char *>(nullptr)
+	};
+
+	SECTION("fills options") {
+		cpparg::ParseResult result;
+
+		REQUIRE(parser.merge_environment(result, envp.data()).has_value());
+
+		REQUIRE(result.get_last_argument_for_option("threads") == "4");
+		REQUIRE(result.count("dry-run") == 1);
+		REQUIRE(result.get_last_argument_for_option("output") == "out.txt");
+		REQUIRE(!result.contains("color"));
+		REQUIRE(result.get_parsed_options().size() == 3);
+		REQUIRE(threads == 4);
+	}
+
+	SECTION("argv takes precedence") {
+		std::array args = { "--output=a.out", "-j2", "file" };
+
+		auto result = parser.parse<cpparg::ParseResultView>(args.begin(), args.end());
+
+		REQUIRE(result.has_value());
+		REQUIRE(parser.merge_environment(*result, envp.data()).has_value());
+
+		REQUIRE(result->get_arguments_for_option("output").size() == 1);
+		REQUIRE(result->get_last_argument_for_option("output") == "a.out");
+		REQUIRE(result->get_last_argument_for_option("threads") == "2");
+		REQUIRE(result->count("dry-run") == 1);
+		REQUIRE(result->get_positional_arguments().size() == 1);
+		REQUIRE(threads == 2);
+	}
+
+	SECTION("false flag") {
+		std::array false_envp = { "APP_DRY_RUN=off", static_cast<const char *>(nullptr) };
+
+		cpparg::ParseResult result;
+
+		REQUIRE(parser.merge_environment(result, false_envp.data()).has_value());
+
+		REQUIRE(!result.contains("dry-run"));
+	}
+
+	SECTION("invalid value") {
+		std::array invalid_envp = { "APP_COLOR=", "APP_DRY_RUN=maybe", static_cast<const char *>(nullptr) };
+
+		cpparg::ParseResult result;
+
+		auto merged = parser.merge_environment(result, invalid_envp.data());
+
+		REQUIRE(!merged.has_value());
+		REQUIRE(merged.error().originating_arg == 1);
+		REQUIRE(merged.error().what.contains("APP_DRY_RUN"));
+		REQUIRE(result.get_last_argument_for_option("color") == "");
+	}
+
+	SECTION("invalid bound value") {
+		std::array invalid_envp = { "APP_THREADS=four", static_cast<const char *>(nullptr) };
+
+		cpparg::ParseResult result;
+
+		auto merged = parser.merge_environment(result, invalid_envp.data());
+
+		REQUIRE(!merged.has_value());
+		REQUIRE(merged.error().originating_arg == 0);
+		REQUIRE(merged.error().what.contains("APP_THREADS"));
+		REQUIRE(threads == 1);
+
+		// Bound variables are only set if all variables are valid
+		std::array later_invalid_envp = { "APP_THREADS=4", "APP_DRY_RUN=maybe", static_cast<const char *>(nullptr) };
+
+		cpparg::ParseResult later_result;
+
+		REQUIRE(!parser.merge_environment(later_result, later_invalid_envp.data()).has_value());
+		REQUIRE(threads == 1);
+	}
+
+	SECTION("no prefix") {
+		parser.set_env_prefix("");
+
+		cpparg::ParseResult result;
+
+		REQUIRE(parser.merge_environment(result, envp.data()).has_value());
+
+		REQUIRE(result.get_parsed_options().empty());
+	}
+
+#if !defined(_WIN32)
+	SECTION("parse_argv") {
+		::setenv("CPPARG_TEST_OUTPUT", "env.txt", 1);
+		::setenv("CPPARG_TEST_THREADS", "8", 1);
+
+		parser.set_env_prefix("CPPARG_TEST");
+
+		std::array argv = { "app", "-j", "3" };
+
+		auto result = parser.parse_argv(argv.size(), argv.data());
+
+		::unsetenv("CPPARG_TEST_OUTPUT");
+		::unsetenv("CPPARG_TEST_THREADS");
+
+		REQUIRE(result.has_value());
+		REQUIRE(result->get_last_argument_for_option("output") == "env.txt");
+		REQUIRE(result->get_last_argument_for_option("threads") == "3");
+		REQUIRE(threads == 3);
+	}
+
+	SECTION("parse_argv invalid value") {
+		::setenv("CPPARG_TEST_DRY_RUN", "maybe", 1);
+
+		parser.set_env_prefix("CPPARG_TEST");
+
+		std::array argv = { "app", "-j", "3", "file" };
+
+		auto result = parser.parse_argv(argv.size(), argv.data());
+
+		::unsetenv("CPPARG_TEST_DRY_RUN");
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == argv.size());
+		REQUIRE(result.error().what.contains("CPPARG_TEST_DRY_RUN"));
+		REQUIRE(threads == 1);
+	}
+
+	SECTION("parse_argv invalid value with response file") {
+		auto path = std::filesystem::temp_directory_path() / "cpparg_test_environment";
+
+		std::ofstream(path, std::ios::binary) << "-j 3";
+
+		::setenv("CPPARG_TEST_DRY_RUN", "maybe", 1);
+
+		parser.set_env_prefix("CPPARG_TEST").allow_response_files();
+
+		auto response_file = "@" + path.string();
+
+		std::array argv = { "app", response_file.c_str() };
+
+		auto result = parser.parse_argv<cpparg::ParseResultView>(argv.size(), argv.data());
+
+		::unsetenv("CPPARG_TEST_DRY_RUN");
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == argv.size());
+		REQUIRE(threads == 1);
+	}
+#endif
+}
+
+TEST_CASE("config", "[cpparg]") {
+	int threads = 1;
+
+	cpparg::OptionParser parser;
+
+	parser.add_option("j", "threads", "N", "number of threads").bind(threads)
+	      .add_option("", "dry-run", "", "do nothing")
+	      .add_option("", "color", "[=WHEN]", "use color")
+	      .add_option("I", "include", "DIR", "include directory")
+	      .add_option("o", "output", "FILE", "output file");
+
+	constexpr std::string_view config =
+		"# comment\n"
+		"\n"
+		"threads = 4\n"
+		"  ; indented comment\r\n"
+		"dry-run=yes\r\n"
+		"--color\n"
+		"--include /usr/include\n"
+		"include=\"/opt/my include\"\n"
+		"output = a.out";
+
+	SECTION("fills options") {
+		cpparg::ParseResultView result;
+
+		REQUIRE(parser.merge_config(result, config).has_value());
+
+		REQUIRE(threads == 4);
+		REQUIRE(result.get_last_argument_for_option("threads") == "4");
+		REQUIRE(result.count("dry-run") == 1);
+		REQUIRE(result.count("color") == 1);
+		REQUIRE(result.get_arguments_for_option("color").empty());
+		REQUIRE(result.get_arguments_for_option("include") == std::vector<std::string_view>{"/usr/include", "/opt/my include"});
+		REQUIRE(result.get_last_argument_for_option("output") == "a.out");
+		REQUIRE(result.get_last_argument_for_option("output")->data() == config.data() + config.size() - 5);
+	}
+
+	SECTION("argv takes precedence") {
+		std::array args = { "-I", "src", "--threads=2" };
+
+		auto result = parser.parse(args.begin(), args.end());
+
+		REQUIRE(result.has_value());
+		REQUIRE(parser.merge_config(*result, config).has_value());
+
+		REQUIRE(result->get_arguments_for_option("include") == std::vector<std::string>{"src"});
+		REQUIRE(result->get_last_argument_for_option("threads") == "2");
+		REQUIRE(result->get_last_argument_for_option("output") == "a.out");
+		REQUIRE(threads == 2);
+	}
+
+	SECTION("false flag") {
+		cpparg::ParseResult result;
+
+		REQUIRE(parser.merge_config(result, "dry-run = off").has_value());
+
+		REQUIRE(!result.contains("dry-run"));
+	}
+
+	SECTION("errors") {
+		auto error_line = [&](std::string_view text) {
+			cpparg::ParseResult result;
+
+			auto merged = parser.merge_config(result, text, "app.conf");
+
+			REQUIRE(!merged.has_value());
+			REQUIRE(merged.error().what.starts_with(std::format("app.conf:{}: ", merged.error().originating_arg)));
+
+			return merged.error().originating_arg;
+		};
+
+		REQUIRE(error_line("threads=1\nunknown=2") == 2);
+		REQUIRE(error_line("\n\n--output") == 3);
+		REQUIRE(error_line("threads = four") == 1);
+		REQUIRE(error_line("dry-run = maybe") == 1);
+		REQUIRE(error_line("# comment\n[section]") == 2);
+
+		// Bound variables are only set if all lines are valid
+		REQUIRE(error_line("threads = 3\nunknown=2") == 2);
+		REQUIRE(threads == 1);
+	}
+
+	SECTION("file") {
+		auto path = std::filesystem::temp_directory_path() / "cpparg_test_config";
+
+		std::ofstream(path, std::ios::binary) << config;
+
+		cpparg::ParseResultView result;
+
+		REQUIRE(parser.merge_config_file(result, path.string().c_str()).has_value());
+
+		REQUIRE(result.get_last_argument_for_option("output") == "a.out");
+		REQUIRE(result.get_arguments_for_option("include").size() == 2);
+
+		std::filesystem::remove(path);
+
+		// Result keeps contents alive
+		REQUIRE(result.get_last_argument_for_option("output") == "a.out");
+
+		auto missing = parser.merge_config_file(result, path.string().c_str());
+
+		REQUIRE(!missing.has_value());
+		REQUIRE(missing.error().originating_arg == 0);
+	}
+}
+
+TEST_CASE("subcommands", "[cpparg]") {
+	int commit_created = 0;
+	int push_created = 0;
+	bool force = false;
+
+	cpparg::OptionParser parser;
+
+	parser.add_option("v", "verbose", "", "be verbose")
+	      .add_subcommand("commit", [&] {
+	          ++commit_created;
+
+	          cpparg::OptionParser commit;
+	          commit.add_option("m", "message", "MSG", "commit message")
+	                .add_option("a", "all", "", "commit all");
+	          return commit;
+	      })
+	      .add_subcommand("push", [&] {
+	          ++push_created;
+
+	          cpparg::OptionParser push;
+	          push.add_option("f", "force", "", "force").bind(force);
+	          return push;
+	      });
+
+	SECTION("dispatch") {
+		std::array args = { "-v", "commit", "-am", "fix", "file", "--", "-v" };
+
+		auto result = parser.parse<cpparg::ParseResultView>(args.begin(), args.end());
+
+		REQUIRE(result.has_value());
+		REQUIRE(commit_created == 1);
+		REQUIRE(push_created == 0);
+
+		REQUIRE(result->count("verbose") == 1);
+		REQUIRE(result->get_positional_arguments().empty());
+		REQUIRE(result->get_subcommand() == "commit");
+		REQUIRE(result->get_subcommand()->data() == args[1]);
+
+		auto *commit = result->get_subcommand_result();
+
+		REQUIRE(commit != nullptr);
+		REQUIRE(commit->count("all") == 1);
+		REQUIRE(commit->get_last_argument_for_option("message") == "fix");
+		REQUIRE(commit->get_positional_arguments().size() == 2);
+		REQUIRE(commit->get_positional_arguments()[0].data() == args[4]);
+		REQUIRE(commit->get_positional_arguments()[1] == "-v");
+		REQUIRE(!commit->get_subcommand());
+
+		cpparg::ParseResultView copy(*result, result->get_allocator());
+
+		REQUIRE(copy.get_subcommand() == "commit");
+		REQUIRE(copy.get_subcommand_result() != commit);
+		REQUIRE(copy.get_subcommand_result()->get_last_argument_for_option("message") == "fix");
+	}
+
+	SECTION("factory called once") {
+		std::array args = { "push", "-f" };
+
+		for (int i = 0; i < 3; ++i) {
+			force = false;
+
+			REQUIRE(parser.parse(args.begin(), args.end()).has_value());
+			REQUIRE(force);
+		}
+
+		REQUIRE(push_created == 1);
+		REQUIRE(commit_created == 0);
+
+		// Copies share subcommand parsers
+		auto copy = parser;
+
+		REQUIRE(copy.parse(args.begin(), args.end()).has_value());
+		REQUIRE(copy.get_subcommand_parser("push") == parser.get_subcommand_parser("push"));
+		REQUIRE(push_created == 1);
+
+		REQUIRE(parser.get_subcommand_parser("pull") == nullptr);
+	}
+
+	SECTION("no subcommand") {
+		std::array args = { "-v" };
+
+		auto result = parser.parse(args.begin(), args.end());
+
+		REQUIRE(result.has_value());
+		REQUIRE(!result->get_subcommand());
+		REQUIRE(result->get_subcommand_result() == nullptr);
+	}
+
+	SECTION("not after double dash") {
+		std::array args = { "-v", "--", "commit", "--all" };
+
+		auto result = parser.parse<cpparg::ParseResultView>(args.begin(), args.end());
+
+		REQUIRE(result.has_value());
+		REQUIRE(commit_created == 0);
+		REQUIRE(!result->get_subcommand());
+		REQUIRE(result->count("verbose") == 1);
+		REQUIRE(result->get_positional_arguments().size() == 2);
+		REQUIRE(result->get_positional_arguments()[0] == "commit");
+		REQUIRE(result->get_positional_arguments()[1] == "--all");
+
+		std::array file_args = { "--", "file" };
+
+		result = parser.parse<cpparg::ParseResultView>(file_args.begin(), file_args.end());
+
+		REQUIRE(result.has_value());
+		REQUIRE(!result->get_subcommand());
+		REQUIRE(result->get_positional_arguments().size() == 1);
+		REQUIRE(result->get_positional_arguments()[0] == "file");
+	}
+
+	SECTION("errors") {
+		std::array unknown = { "-v", "pull" };
+
+		auto result = parser.parse(unknown.begin(), unknown.end());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 1);
+
+		std::array child_error = { "-v", "commit", "-a", "--unknown" };
+
+		result = parser.parse(child_error.begin(), child_error.end());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 3);
+
+		std::array argv = { "app", "commit", "-m" };
+
+		result = parser.parse_argv(argv.size(), argv.data());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(result.error().originating_arg == 2);
+
+		std::array push_error = { "push", "-f", "--unknown" };
+
+		result = parser.parse(push_error.begin(), push_error.end());
+
+		REQUIRE(!result.has_value());
+		REQUIRE(!force);
+	}
+
+	SECTION("parse_into reuses result") {
+		std::array commit_args = { "commit", "-a" };
+		std::array push_args = { "-v", "push" };
+
+		cpparg::ParseResult result;
+
+		REQUIRE(parser.parse_into(result, commit_args.begin(), commit_args.end()).has_value());
+		REQUIRE(result.get_subcommand_result()->count("all") == 1);
+
+		auto copy = result;
+
+		auto *first_subcommand_result = result.get_subcommand_result();
+
+		REQUIRE(parser.parse_into(result, push_args.begin(), push_args.end()).has_value());
+		REQUIRE(result.get_subcommand() == "push");
+		REQUIRE(result.get_subcommand_result() != first_subcommand_result);
+		REQUIRE(!result.get_subcommand_result()->contains("all"));
+
+		// Copy is unchanged
+		REQUIRE(copy.get_subcommand() == "commit");
+		REQUIRE(copy.get_subcommand_result()->count("all") == 1);
+
+		auto *second_subcommand_result = result.get_subcommand_result();
+
+		REQUIRE(parser.parse_into(result, commit_args.begin(), commit_args.end()).has_value());
+		REQUIRE(result.get_subcommand_result() == second_subcommand_result);
+	}
+}
+
+TEST_CASE("convert_to<signed>", "[cpparg]") {
+	SECTION("simple") {
+		REQUIRE(cpparg::convert_to<int>("42") == 42);
+		REQUIRE(cpparg::convert_to<int>("-42") == -42);
+	}
+
+	SECTION("base 16") {
+		REQUIRE(cpparg::convert_to<int>("0x20", 16) == 32);
+		REQUIRE(cpparg::convert_to<int>("20", 16) == 32);
+		REQUIRE(cpparg::convert_to<int>("-0x20", 16) == -32);
+		REQUIRE(cpparg::convert_to<int>("-20", 16) == -32);
+	}
+
+	SECTION("base 8") {
+		REQUIRE(cpparg::convert_to<int>("0644", 8) == 0b110'100'100);
+		REQUIRE(cpparg::convert_to<int>("644", 8) == 0b110'100'100);
+	}
+
+	SECTION("base 2") {
+		REQUIRE(cpparg::convert_to<int>("0b1011", 2) == 0b1011);
+		REQUIRE(cpparg::convert_to<int>("1011", 2) == 0b1011);
+	}
+
+
+	SECTION("base 0") {
+		REQUIRE(cpparg::convert_to<int>("0x20", 0) == 32);
+		REQUIRE(cpparg::convert_to<int>("-0x20", 0) == -32);
+		REQUIRE(cpparg::convert_to<int>("0644", 0) == 0b110'100'100);
+		REQUIRE(cpparg::convert_to<int>("0b1011", 0) == 0b1011);
+	}
+
+	SECTION("limits") {
+		REQUIRE(cpparg::convert_to<std::int8_t>("127") == 127);
+		REQUIRE(!cpparg::convert_to<std::int8_t>("128"));
+		REQUIRE(cpparg::convert_to<std::int8_t>("-128") == -128);
+		REQUIRE(!cpparg::convert_to<std::int8_t>("-129"));
+	}
+
+	SECTION("invalid") {
+		REQUIRE(!cpparg::convert_to<int>(""));
+		REQUIRE(!cpparg::convert_to<int>("20h"));
+		REQUIRE(!cpparg::convert_to<int>("42 "));
+		REQUIRE(!cpparg::convert_to<int>(" 42"));
+		REQUIRE(!cpparg::convert_to<int>("x20", 16));
+		REQUIRE(!cpparg::convert_to<int>("0102010", 2));
+		REQUIRE(!cpparg::convert_to<int>("0649", 8));
+	}
+
+	SECTION("decimal suffix") {
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1k") == 1'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1K") == 1'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1m") == 1'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1M") == 1'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1g") == 1'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1G") == 1'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1t") == 1'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1T") == 1'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1p") == 1'000'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1P") == 1'000'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1e") == 1'000'000'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::decimal>("1E") == 1'000'000'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::decimal>("32k") == 32 * 1000);
+		REQUIRE(cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::decimal>("-32k") == -32 * 1000);
+		REQUIRE(!cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::decimal>("33k"));
+		REQUIRE(!cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::decimal>("-33k"));
+	}
+
+	SECTION("binary suffix") {
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1k") == 1LL << 10);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1K") == 1LL << 10);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1m") == 1LL << 20);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1M") == 1LL << 20);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1g") == 1LL << 30);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1G") == 1LL << 30);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1t") == 1LL << 40);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1T") == 1LL << 40);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1p") == 1LL << 50);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1P") == 1LL << 50);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1e") == 1LL << 60);
+		REQUIRE(cpparg::convert_to<std::int64_t, cpparg::KiloMultiplier::binary>("1E") == 1LL << 60);
+		REQUIRE(cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::binary>("31k") == 31 * 1024);
+		REQUIRE(cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::binary>("-32k") == -32 * 1024);
+		REQUIRE(!cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::binary>("32k"));
+		REQUIRE(!cpparg::convert_to<std::int16_t, cpparg::KiloMultiplier::binary>("-33k"));
+	}
+}
+
+TEST_CASE("convert_to<unsigned>", "[cpparg]") {
+	SECTION("simple") {
+		REQUIRE(cpparg::convert_to<unsigned int>("42") == 42U);
+		REQUIRE(cpparg::convert_to<unsigned int>("-42") == -42U);
+	}
+
+	SECTION("base 16") {
+		REQUIRE(cpparg::convert_to<unsigned int>("0x20", 16) == 32U);
+		REQUIRE(cpparg::convert_to<unsigned int>("20", 16) == 32U);
+		REQUIRE(cpparg::convert_to<unsigned int>("-0x20", 16) == -32U);
+		REQUIRE(cpparg::convert_to<unsigned int>("-20", 16) == -32U);
+	}
+
+	SECTION("base 8") {
+		REQUIRE(cpparg::convert_to<unsigned int>("0644", 8) == 0b110'100'100);
+		REQUIRE(cpparg::convert_to<unsigned int>("644", 8) == 0b110'100'100);
+	}
+
+	SECTION("base 2") {
+		REQUIRE(cpparg::convert_to<unsigned int>("0b1011", 2) == 0b1011);
+		REQUIRE(cpparg::convert_to<unsigned int>("1011", 2) == 0b1011);
+	}
+
+
+	SECTION("base 0") {
+		REQUIRE(cpparg::convert_to<unsigned int>("0x20", 0) == 32U);
+		REQUIRE(cpparg::convert_to<unsigned int>("-0x20", 0) == -32U);
+		REQUIRE(cpparg::convert_to<unsigned int>("0644", 0) == 0b110'100'100);
+		REQUIRE(cpparg::convert_to<unsigned int>("0b1011", 0) == 0b1011);
+	}
+
+	SECTION("limits") {
+		REQUIRE(cpparg::convert_to<std::uint8_t>("255") == 255U);
+		REQUIRE(!cpparg::convert_to<std::uint8_t>("256"));
+		REQUIRE(cpparg::convert_to<std::uint8_t>("-1") == 255U);
+		REQUIRE(cpparg::convert_to<std::uint8_t>("-255") == 1U);
+		REQUIRE(!cpparg::convert_to<std::uint8_t>("-256"));
+	}
+
+	SECTION("long digit strings") {
+		REQUIRE(cpparg::convert_to<std::uint64_t>("18446744073709551615") == 18446744073709551615ULL);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("18446744073709551616").error() == std::errc::result_out_of_range);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("99999999999999999999").error() == std::errc::result_out_of_range);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("1234567890123456789") == 1234567890123456789ULL);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("0000000000000000000000001234567890") == 1234567890ULL);
+		REQUIRE(cpparg::convert_to<std::uint32_t>("4294967295") == 4294967295U);
+		REQUIRE(cpparg::convert_to<std::uint32_t>("4294967296").error() == std::errc::result_out_of_range);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("ffffffffffffffff", 16) == 0xFFFFFFFFFFFFFFFFULL);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("0123456789ABCDEF", 16) == 0x0123456789ABCDEFULL);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("0x00000000fedcba98", 16) == 0xFEDCBA98ULL);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("10000000000000000", 16).error() == std::errc::result_out_of_range);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("12345678901234567890x").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("123456789012345678901234x").error() == std::errc::result_out_of_range);
+		REQUIRE(cpparg::convert_to<std::uint64_t>("1234567g", 16).error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("12345678K") == 12345678ULL << 10);
+	}
+
+	SECTION("invalid") {
+		REQUIRE(!cpparg::convert_to<unsigned int>(""));
+		REQUIRE(!cpparg::convert_to<unsigned int>("20h"));
+		REQUIRE(!cpparg::convert_to<unsigned int>("42 "));
+		REQUIRE(!cpparg::convert_to<unsigned int>(" 42"));
+		REQUIRE(!cpparg::convert_to<unsigned int>("x20", 16));
+		REQUIRE(!cpparg::convert_to<unsigned int>("0102010", 2));
+		REQUIRE(!cpparg::convert_to<unsigned int>("0649", 8));
+	}
+
+	SECTION("decimal suffix") {
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1k") == 1'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1K") == 1'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1m") == 1'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1M") == 1'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1g") == 1'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1G") == 1'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1t") == 1'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1T") == 1'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1p") == 1'000'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1P") == 1'000'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1e") == 1'000'000'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::decimal>("1E") == 1'000'000'000'000'000'000LL);
+		REQUIRE(cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::decimal>("65k") == 65U * 1000);
+		REQUIRE(cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::decimal>("-65k") == static_cast<std::uint16_t>(-(65U * 1000)));
+		REQUIRE(!cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::decimal>("66k"));
+	}
+
+	SECTION("binary suffix") {
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1k") == 1ULL << 10);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1K") == 1ULL << 10);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1m") == 1ULL << 20);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1M") == 1ULL << 20);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1g") == 1ULL << 30);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1G") == 1ULL << 30);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1t") == 1ULL << 40);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1T") == 1ULL << 40);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1p") == 1ULL << 50);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1P") == 1ULL << 50);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1e") == 1ULL << 60);
+		REQUIRE(cpparg::convert_to<std::uint64_t, cpparg::KiloMultiplier::binary>("1E") == 1ULL << 60);
+		REQUIRE(cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::binary>("63k") == 63U * 1024);
+		REQUIRE(cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::binary>("-63k") == static_cast<std::uint16_t>(-(63U * 1024)));
+		REQUIRE(!cpparg::convert_to<std::uint16_t, cpparg::KiloMultiplier::binary>("64k"));
+	}
+}
+
+TEST_CASE("convert_to<floating>", "[cpparg]") {
+	SECTION("simple") {
+		REQUIRE(cpparg::convert_to<double>("0.125") == 0.125);
+		REQUIRE(cpparg::convert_to<double>("-2.5") == -2.5);
+		REQUIRE(cpparg::convert_to<double>("1e3") == 1000.0);
+		REQUIRE(cpparg::convert_to<float>("42") == 42.0f);
+		REQUIRE(std::isinf(*cpparg::convert_to<double>("inf")));
+		REQUIRE(std::isnan(*cpparg::convert_to<double>("nan")));
+	}
+
+	SECTION("percent") {
+		REQUIRE(cpparg::convert_to<double>("12.5%") == 0.125);
+		REQUIRE(cpparg::convert_to<double>("-50%") == -0.5);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("100%") == 1.0);
+	}
+
+	SECTION("suffix") {
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("1.5k") == 1500.0);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("2M") == 2e6);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("1E") == 1e18);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::binary>("1.5K") == 1536.0);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::binary>("1.5G") == 1.5 * (1ULL << 30));
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::binary>("-0.5T") == -0.5 * (1ULL << 40));
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::binary>("2e3K") == 2e3 * 1024);
+	}
+
+	SECTION("limits") {
+		REQUIRE(cpparg::convert_to<double>("1e400").error() == std::errc::result_out_of_range);
+		REQUIRE(cpparg::convert_to<float>("1e39").error() == std::errc::result_out_of_range);
+		REQUIRE(cpparg::convert_to<float, cpparg::KiloMultiplier::decimal>("1e30E").error() == std::errc::result_out_of_range);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("1e300E").error() == std::errc::result_out_of_range);
+		REQUIRE(std::isinf(*cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("infK")));
+	}
+
+	SECTION("invalid") {
+		REQUIRE(cpparg::convert_to<double>("").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<double>(" 1").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<double>("+1").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<double>("1.5K").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<double>("1.5 ").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<double>("0x10").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("1KB").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("1X").error() == std::errc::invalid_argument);
+		REQUIRE(cpparg::convert_to<double, cpparg::KiloMultiplier::decimal>("%").error() == std::errc::invalid_argument);
+	}
+}
 
 TEST_CASE("convert_to<bool>", "[cpparg]") {
 	SECTION("simple") {
@@ -726,3 +2549,174 @@ TEST_CASE("convert_to<bool>", "[cpparg]") {
 		REQUIRE(!cpparg::convert_to<bool>("-1"));
 	}
 }
+
+TEST_CASE("convert_list", "[cpparg]") {
+	SECTION("vector") {
+		std::vector<int> values;
+
+		REQUIRE(cpparg::convert_list<int>("1,-5,9,42", ',', values).has_value());
+
+		REQUIRE(values == std::vector<int>{1, -5, 9, 42});
+
+		// Appends to values
+		REQUIRE(cpparg::convert_list<int>("7", ',', values).has_value());
+
+		REQUIRE(values.size() == 5);
+		REQUIRE(values.back() == 7);
+	}
+
+	SECTION("output iterator") {
+		std::array<std::uint64_t, 4> values{};
+
+		auto res = cpparg::convert_list<std::uint64_t, cpparg::KiloMultiplier::binary>("1K:2:3M", ':', values.begin());
+
+		REQUIRE(res.has_value());
+		REQUIRE(*res == values.begin() + 3);
+		REQUIRE(values[0] == 1024);
+		REQUIRE(values[1] == 2);
+		REQUIRE(values[2] == 3 << 20);
+	}
+
+	SECTION("other types") {
+		std::vector<double> doubles;
+
+		REQUIRE(cpparg::convert_list<double>("0.5,25%,1e3", ',', doubles).has_value());
+		REQUIRE(doubles == std::vector<double>{0.5, 0.25, 1000.0});
+
+		std::vector<bool> bools;
+
+		REQUIRE(cpparg::convert_list<bool>("yes,off,1", ',', bools).has_value());
+		REQUIRE(bools == std::vector<bool>{true, false, true});
+	}
+
+	SECTION("empty") {
+		std::vector<int> values;
+
+		REQUIRE(cpparg::convert_list<int>("", ',', values).has_value());
+		REQUIRE(values.empty());
+	}
+
+	SECTION("errors") {
+		std::vector<std::uint8_t> values;
+
+		auto res = cpparg::convert_list<std::uint8_t>("1,2,300,4", ',', values);
+
+		REQUIRE(!res.has_value());
+		REQUIRE(res.error().index == 2);
+		REQUIRE(res.error().error == std::errc::result_out_of_range);
+		REQUIRE(values.size() == 2);
+
+		res = cpparg::convert_list<std::uint8_t>("1,,2", ',', values);
+
+		REQUIRE(!res.has_value());
+		REQUIRE(res.error().index == 1);
+		REQUIRE(res.error().error == std::errc::invalid_argument);
+
+		res = cpparg::convert_list<std::uint8_t>("1,2,", ',', values);
+
+		REQUIRE(!res.has_value());
+		REQUIRE(res.error().index == 2);
+	}
+}
+
+TEST_CASE("split_command_line", "[cpparg]") {
+	CountingResource upstream;
+	std::pmr::monotonic_buffer_resource resource(&upstream);
+
+	auto split = [&](std::string_view command_line) {
+		auto args = cpparg::split_command_line(command_line, &resource);
+
+		REQUIRE(args.has_value());
+
+		return std::vector<std::string_view>(args->begin(), args->end());
+	};
+
+	using args_type = std::vector<std::string_view>;
+
+	SECTION("unquoted") {
+		REQUIRE(split("").empty());
+		REQUIRE(split(" \t\n ").empty());
+		REQUIRE(split("a") == args_type{"a"});
+		REQUIRE(split("  cc\t-o app\nmain.c  ") == args_type{"cc", "-o", "app", "main.c"});
+		REQUIRE(split("a-long-argument-spanning-words a$b;c") == args_type{"a-long-argument-spanning-words", "a$b;c"});
+	}
+
+	SECTION("unquoted arguments refer to source") {
+		std::string_view command_line = "app --output=file.txt 'quoted arg'";
+
+		auto args = cpparg::split_command_line(command_line, &resource);
+
+		REQUIRE(args.has_value());
+		REQUIRE(args->size() == 3);
+		REQUIRE((*args)[0].data() == command_line.data());
+		REQUIRE((*args)[1].data() == command_line.data() + 4);
+		REQUIRE((*args)[2] == "quoted arg");
+		REQUIRE((*args)[2].data() != command_line.data() + 23);
+	}
+
+	SECTION("quoting") {
+		REQUIRE(split(R"('single  quoted' "double  quoted")") == args_type{"single  quoted", "double  quoted"});
+		REQUIRE(split(R"(a'b'"c"d e)") == args_type{"abcd", "e"});
+		REQUIRE(split(R"('' "")") == args_type{"", ""});
+		REQUIRE(split(R"('a\b"c')") == args_type{R"(a\b"c)"});
+		REQUIRE(split(R"("it's")") == args_type{"it's"});
+	}
+
+	SECTION("backslash") {
+		REQUIRE(split(R"(a\ b c\\d \'e)") == args_type{"a b", R"(c\d)", "'e"});
+		REQUIRE(split(R"("a\"b\\c\$d\e")") == args_type{R"(a"b\c$d\e)"});
+		REQUIRE(split("a \\\n b\\\nc") == args_type{"a", "bc"});
+		REQUIRE(split("\"a\\\nb\"") == args_type{"ab"});
+	}
+
+	SECTION("long arguments") {
+		std::string long_arg(100, 'x');
+
+		REQUIRE(split(long_arg + " '" + long_arg + "'\x01" + long_arg) == args_type{long_arg, long_arg + "\x01" + long_arg});
+	}
+
+	SECTION("errors") {
+		auto error_position = [&](std::string_view command_line) {
+			auto args = cpparg::split_command_line(command_line, &resource);
+
+			REQUIRE(!args.has_value());
+
+			return args.error().originating_arg;
+		};
+
+		REQUIRE(error_position("a 'b") == 2);
+		REQUIRE(error_position("a \"b\\\"") == 2);
+		REQUIRE(error_position("a b\\") == 3);
+		REQUIRE(error_position("\"a\" 'b' \"c") == 8);
+	}
+
+	SECTION("memory is released with arena") {
+		CountingResource counting;
+
+		{
+			std::pmr::monotonic_buffer_resource arena(&counting);
+
+			auto args = cpparg::split_command_line(R"('one' "two\"" three\ four five)", &arena);
+
+			REQUIRE(args.has_value());
+			REQUIRE(args->size() == 4);
+			REQUIRE(counting.allocations > 0);
+			REQUIRE(counting.bytes_in_use > 0);
+		}
+
+		REQUIRE(counting.bytes_in_use == 0);
+	}
+
+	SECTION("parse") {
+		auto args = cpparg::split_command_line("-n --reqarg 'two words' foo", &resource);
+
+		REQUIRE(args.has_value());
+
+		auto result = default_parser.parse<cpparg::ParseResultView>(args->begin(), args->end());
+
+		REQUIRE(result.has_value());
+		REQUIRE(result->count("noarg") == 1);
+		REQUIRE(result->get_last_argument_for_option("reqarg") == "two words");
+		REQUIRE(result->get_positional_arguments().size() == 1);
+	}
+}